@@ -1,6 +1,7 @@
 #include "stdio.h"
 #include "stdlib.h"
 #include "string.h"
+#include "math.h"
 #include "mpu6050.h"
 
 #define MPU6050_SELF_TEST_X         0x0D        /*!< SELF TEST REGISTERS */
@@ -88,11 +89,16 @@
 #define MPU6050_ADDR                (0x68<<1)   /*!< MPU6050 Address */
 
 #define BUFFER_CALIB_DEFAULT        1000        /*!< Default the number of sample data when calibrate */
+#define SMPLRT_DIV_DEFAULT          4           /*!< Default sample rate divider */
+#define CONVERT_BLOCK_SIZE          32          /*!< Samples per block in batch conversion */
+#define CONFIG_STEP_DELAY_MS        10          /*!< Delay after reset and after clock selection */
+#define SELF_TEST_SAMPLE_MAX        64          /*!< Maximum number of samples averaged per self-test phase */
 
 
 typedef struct mpu6050 {
 	mpu6050_clksel_t        	clksel;         			/*!< MPU6050 clock source */
 	mpu6050_dlpf_cfg_t      	dlpf_cfg;       			/*!< MPU6050 digital low pass filter (DLPF) */
+	uint8_t                     smplrt_div;                 /*!< MPU6050 sample rate divider */
 	mpu6050_sleep_mode_t    	sleep_mode;     			/*!< MPU6050 sleep mode */
 	mpu6050_gfs_sel_t        	gfs_sel;         			/*!< MPU6050 gyroscope full scale range */
 	mpu6050_afs_sel_t       	afs_sel;        			/*!< MPU6050 accelerometer full scale range */
@@ -107,8 +113,91 @@ typedef struct mpu6050 {
 	mpu6050_func_delay          delay;                 		/*!< MPU6050 delay function */
 	float                   	accel_scaling_factor;   	/*!< MPU6050 accelerometer scaling factor */
 	float                   	gyro_scaling_factor;    	/*!< MPU6050 gyroscope scaling factor */
+	mpu6050_calib_model_t       accel_model;                /*!< Accelerometer calibration model */
+	mpu6050_calib_model_t       gyro_model;                 /*!< Gyroscope calibration model */
+	float                       accel_coef[3][3];           /*!< Accelerometer raw to calibrated data matrix */
+	float                       accel_coef_offset[3];       /*!< Accelerometer raw to calibrated data offset */
+	float                       gyro_coef[3][3];            /*!< Gyroscope raw to calibrated data matrix */
+	float                       gyro_coef_offset[3];        /*!< Gyroscope raw to calibrated data offset */
+	uint8_t                     fifo_en;                    /*!< FIFO enabled */
 } mpu6050_t;
 
+typedef struct {
+	float                       accel_mean[2][3];           /*!< Accelerometer mean with self-test disabled, enabled */
+	float                       gyro_mean[2][3];            /*!< Gyroscope mean with self-test disabled, enabled */
+	uint8_t                     fifo_en;                    /*!< FIFO state before self-test */
+	err_code_t                  restore_err;                /*!< Error restoring configuration */
+} mpu6050_self_test_state_t;
+
+/* Select gyroscope x, y, z and accelerometer data. FIFO_RESET only takes
+ * effect while FIFO_EN is 0: disable, reset, enable.
+ */
+static const mpu6050_reg_write_t fifo_enable_seq[] = {
+	{MPU6050_FIFO_EN,   0x78},
+	{MPU6050_USER_CTRL, 0x00},
+	{MPU6050_USER_CTRL, 0x04},
+	{MPU6050_USER_CTRL, 0x40},
+};
+
+static void mpu6050_calc_coef(const mpu6050_calib_model_t *model, float scaling_factor,
+                              int16_t bias_x, int16_t bias_y, int16_t bias_z,
+                              float coef[3][3], float coef_offset[3])
+{
+	/* calib = M * ((raw - bias) * s) + offset = (M * s) * raw + (offset - (M * s) * bias) */
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			coef[i][j] = model->matrix[i][j] * scaling_factor;
+		}
+
+		coef_offset[i] = model->offset[i] - (coef[i][0] * bias_x + coef[i][1] * bias_y + coef[i][2] * bias_z);
+	}
+}
+
+static void mpu6050_update_coef(mpu6050_handle_t handle)
+{
+	mpu6050_calc_coef(&handle->accel_model, handle->accel_scaling_factor,
+	                  handle->accel_bias_x, handle->accel_bias_y, handle->accel_bias_z,
+	                  handle->accel_coef, handle->accel_coef_offset);
+	mpu6050_calc_coef(&handle->gyro_model, handle->gyro_scaling_factor,
+	                  handle->gyro_bias_x, handle->gyro_bias_y, handle->gyro_bias_z,
+	                  handle->gyro_coef, handle->gyro_coef_offset);
+}
+
+static void mpu6050_apply_coef(const float coef[3][3], const float coef_offset[3],
+                               int16_t raw_x, int16_t raw_y, int16_t raw_z,
+                               float *out_x, float *out_y, float *out_z)
+{
+	*out_x = coef[0][0] * raw_x + coef[0][1] * raw_y + coef[0][2] * raw_z + coef_offset[0];
+	*out_y = coef[1][0] * raw_x + coef[1][1] * raw_y + coef[1][2] * raw_z + coef_offset[1];
+	*out_z = coef[2][0] * raw_x + coef[2][1] * raw_y + coef[2][2] * raw_z + coef_offset[2];
+}
+
+static void mpu6050_decode_sample(const uint8_t *accel_data, const uint8_t *gyro_data, mpu6050_raw_sample_t *sample)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		sample->accel[i] = (int16_t)((accel_data[2 * i] << 8) + accel_data[2 * i + 1]);
+		sample->gyro[i] = (int16_t)((gyro_data[2 * i] << 8) + gyro_data[2 * i + 1]);
+	}
+}
+
+static void mpu6050_apply_coef_block(const float coef[3][3], const float coef_offset[3],
+                                     const float in[3][CONVERT_BLOCK_SIZE], float out[3][CONVERT_BLOCK_SIZE],
+                                     uint32_t num_sample)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		const float c0 = coef[i][0], c1 = coef[i][1], c2 = coef[i][2], o = coef_offset[i];
+
+		for (uint32_t n = 0; n < num_sample; n++)
+		{
+			out[i][n] = c0 * in[0][n] + c1 * in[1][n] + c2 * in[2][n] + o;
+		}
+	}
+}
+
 mpu6050_handle_t mpu6050_init(void)
 {
 	mpu6050_handle_t handle = calloc(1, sizeof(mpu6050_t));
@@ -117,6 +206,15 @@ mpu6050_handle_t mpu6050_init(void)
 		return NULL;
 	}
 
+	handle->smplrt_div = SMPLRT_DIV_DEFAULT;
+
+	/* Default calibration model is identity */
+	for (int i = 0; i < 3; i++)
+	{
+		handle->accel_model.matrix[i][i] = 1.0f;
+		handle->gyro_model.matrix[i][i] = 1.0f;
+	}
+
 	return handle;
 }
 
@@ -194,64 +292,106 @@ err_code_t mpu6050_set_config(mpu6050_handle_t handle, mpu6050_cfg_t config)
 	handle->accel_scaling_factor = accel_scaling_factor;
 	handle->gyro_scaling_factor = gyro_scaling_factor;
 
+	mpu6050_update_coef(handle);
+
 	return ERR_CODE_SUCCESS;
 }
 
-err_code_t mpu6050_config(mpu6050_handle_t handle)
+static err_code_t mpu6050_write_regs(mpu6050_handle_t handle, const mpu6050_reg_write_t *seq, uint8_t len)
 {
-	/* Check if handle structure is NULL */
-	if (handle == NULL)
+	for (uint8_t i = 0; i < len; i++)
 	{
-		return ERR_CODE_NULL_PTR;
+		uint8_t buffer = seq[i].data;
+		err_code_t err = handle->i2c_send(seq[i].reg_addr, &buffer, 1);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			return err;
+		}
 	}
 
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t mpu6050_config_reset(mpu6050_handle_t handle)
+{
 	/* Reset MPU6050 */
-	uint8_t buffer = 0;
-	buffer = 0x80;
-	handle->i2c_send(MPU6050_PWR_MGMT_1, &buffer, 1);
-	handle->delay(10);
+	const mpu6050_reg_write_t seq[] = {
+		{MPU6050_PWR_MGMT_1, 0x80},
+	};
+
+	return mpu6050_write_regs(handle, seq, sizeof(seq) / sizeof(seq[0]));
+}
 
+static err_code_t mpu6050_config_clock(mpu6050_handle_t handle)
+{
 	/* Configure clock source and sleep mode */
-	buffer = 0;
-	buffer = handle->clksel & 0x07;
-	buffer |= (handle->sleep_mode << 6) & 0x40;
-	handle->i2c_send(MPU6050_PWR_MGMT_1, &buffer, 1);
-	handle->delay(10);
-
-	/* Configure digital low pass filter */
-	buffer = 0;
-	buffer = handle->dlpf_cfg & 0x07;
-	handle->i2c_send(MPU6050_CONFIG, &buffer, 1);
-
-	/* Configure gyroscope range */
-	buffer = 0;
-	buffer = (handle->gfs_sel << 3) & 0x18;
-	handle->i2c_send(MPU6050_GYRO_CONFIG, &buffer, 1);
-
-	/* Configure accelerometer range */
-	buffer = 0;
-	buffer = (handle->afs_sel << 3) & 0x18;
-	handle->i2c_send(MPU6050_ACCEL_CONFIG, &buffer, 1);
-
-	/* Configure sample rate divider */
-	buffer = 0;
-	buffer = 0x04;
-	handle->i2c_send(MPU6050_SMPLRT_DIV, &buffer, 1);
-
-	/* Configure interrupt and enable bypass.
+	const mpu6050_reg_write_t seq[] = {
+		{MPU6050_PWR_MGMT_1, (uint8_t)((handle->clksel & 0x07) | ((handle->sleep_mode << 6) & 0x40))},
+	};
+
+	return mpu6050_write_regs(handle, seq, sizeof(seq) / sizeof(seq[0]));
+}
+
+static err_code_t mpu6050_config_apply(mpu6050_handle_t handle)
+{
+	/* Configure digital low pass filter, gyroscope range, accelerometer range
+	 * and sample rate divider.
+	 * Configure interrupt and enable bypass.
 	 * Set Interrupt pin active high, push-pull, Clear and read of INT_STATUS,
 	 * enable I2C_BYPASS_EN in INT_PIN_CFG register so additional chips can
 	 * join the I2C bus and can be controlled by master.
 	 */
-	buffer = 0x22;
-	handle->i2c_send(MPU6050_INT_PIN_CFG, &buffer, 1);
+	const mpu6050_reg_write_t seq[] = {
+		{MPU6050_CONFIG,       (uint8_t)(handle->dlpf_cfg & 0x07)},
+		{MPU6050_GYRO_CONFIG,  (uint8_t)((handle->gfs_sel << 3) & 0x18)},
+		{MPU6050_ACCEL_CONFIG, (uint8_t)((handle->afs_sel << 3) & 0x18)},
+		{MPU6050_SMPLRT_DIV,   handle->smplrt_div},
+		{MPU6050_INT_PIN_CFG,  0x22},
+		{MPU6050_INT_ENABLE,   0x01},
+	};
+
+	err_code_t err = mpu6050_write_regs(handle, seq, sizeof(seq) / sizeof(seq[0]));
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
 
-	buffer = 0x01;
-	handle->i2c_send(MPU6050_INT_ENABLE, &buffer, 1);
+	/* Restore FIFO after reset */
+	if (handle->fifo_en)
+	{
+		return mpu6050_enable_fifo(handle);
+	}
 
 	return ERR_CODE_SUCCESS;
 }
 
+err_code_t mpu6050_config(mpu6050_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+
+	err = mpu6050_config_reset(handle);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+	handle->delay(CONFIG_STEP_DELAY_MS);
+
+	err = mpu6050_config_clock(handle);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+	handle->delay(CONFIG_STEP_DELAY_MS);
+
+	return mpu6050_config_apply(handle);
+}
+
 err_code_t mpu6050_get_accel_raw(mpu6050_handle_t handle, int16_t *raw_x, int16_t *raw_y, int16_t *raw_z)
 {
 	/* Check if handle structure or pointer data is NULL */
@@ -299,9 +439,11 @@ err_code_t mpu6050_get_accel_scale(mpu6050_handle_t handle, float *scale_x, floa
 	uint8_t accel_raw_data[6];
 	handle->i2c_recv(MPU6050_ACCEL_XOUT_H, accel_raw_data, 6);
 
-	*scale_x = (float)((int16_t)((accel_raw_data[0] << 8) + accel_raw_data[1]) - handle->accel_bias_x) * handle->accel_scaling_factor;
-	*scale_y = (float)((int16_t)((accel_raw_data[2] << 8) + accel_raw_data[3]) - handle->accel_bias_y) * handle->accel_scaling_factor;
-	*scale_z = (float)((int16_t)((accel_raw_data[4] << 8) + accel_raw_data[5]) - handle->accel_bias_z) * handle->accel_scaling_factor;
+	mpu6050_apply_coef(handle->accel_coef, handle->accel_coef_offset,
+	                   (int16_t)((accel_raw_data[0] << 8) + accel_raw_data[1]),
+	                   (int16_t)((accel_raw_data[2] << 8) + accel_raw_data[3]),
+	                   (int16_t)((accel_raw_data[4] << 8) + accel_raw_data[5]),
+	                   scale_x, scale_y, scale_z);
 
 	return ERR_CODE_SUCCESS;
 }
@@ -354,9 +496,11 @@ err_code_t mpu6050_get_gyro_scale(mpu6050_handle_t handle, float *scale_x, float
 	uint8_t gyro_raw_data[6];
 	handle->i2c_recv(MPU6050_GYRO_XOUT_H, gyro_raw_data, 6);
 
-	*scale_x = (float)((int16_t)((gyro_raw_data[0] << 8) + gyro_raw_data[1]) - handle->gyro_bias_x) * handle->gyro_scaling_factor;
-	*scale_y = (float)((int16_t)((gyro_raw_data[2] << 8) + gyro_raw_data[3]) - handle->gyro_bias_y) * handle->gyro_scaling_factor;
-	*scale_z = (float)((int16_t)((gyro_raw_data[4] << 8) + gyro_raw_data[5]) - handle->gyro_bias_z) * handle->gyro_scaling_factor;
+	mpu6050_apply_coef(handle->gyro_coef, handle->gyro_coef_offset,
+	                   (int16_t)((gyro_raw_data[0] << 8) + gyro_raw_data[1]),
+	                   (int16_t)((gyro_raw_data[2] << 8) + gyro_raw_data[3]),
+	                   (int16_t)((gyro_raw_data[4] << 8) + gyro_raw_data[5]),
+	                   scale_x, scale_y, scale_z);
 
 	return ERR_CODE_SUCCESS;
 }
@@ -373,6 +517,8 @@ err_code_t mpu6050_set_accel_bias(mpu6050_handle_t handle, int16_t bias_x, int16
 	handle->accel_bias_y = bias_y;
 	handle->accel_bias_z = bias_z;
 
+	mpu6050_update_coef(handle);
+
 	return ERR_CODE_SUCCESS;
 }
 
@@ -388,6 +534,21 @@ err_code_t mpu6050_set_gyro_bias(mpu6050_handle_t handle, int16_t bias_x, int16_
 	handle->gyro_bias_y = bias_y;
 	handle->gyro_bias_z = bias_z;
 
+	mpu6050_update_coef(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_set_sample_rate_div(mpu6050_handle_t handle, uint8_t smplrt_div)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->smplrt_div = smplrt_div;
+
 	return ERR_CODE_SUCCESS;
 }
 
@@ -463,5 +624,681 @@ err_code_t mpu6050_auto_calib(mpu6050_handle_t handle)
 	handle->gyro_bias_y = mean_gy;
 	handle->gyro_bias_z = mean_gz;
 
+	mpu6050_update_coef(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_raw_sample(mpu6050_handle_t handle, mpu6050_raw_sample_t *sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Accelerometer, temperature and gyroscope registers are contiguous */
+	uint8_t raw_data[MPU6050_BURST_SIZE];
+	err_code_t err = handle->i2c_recv(MPU6050_BURST_REG, raw_data, MPU6050_BURST_SIZE);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	return mpu6050_parse_burst(raw_data, sample);
+}
+
+err_code_t mpu6050_parse_burst(const uint8_t *data, mpu6050_raw_sample_t *sample)
+{
+	/* Check if pointer data is NULL */
+	if ((data == NULL) || (sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Temperature sits between accelerometer and gyroscope data */
+	mpu6050_decode_sample(&data[0], &data[8], sample);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_parse_fifo_count(const uint8_t *data, uint16_t max_sample, uint16_t *num_sample)
+{
+	/* Check if pointer data is NULL */
+	if ((data == NULL) || (num_sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*num_sample = 0;
+
+	/* Overflow overwrites oldest data, so sample boundaries are lost */
+	uint16_t count = (uint16_t)((data[0] << 8) + data[1]);
+	if (count >= MPU6050_FIFO_SIZE)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint16_t num = count / MPU6050_FIFO_SAMPLE_SIZE;
+	*num_sample = (num > max_sample) ? max_sample : num;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_parse_fifo(const uint8_t *data, uint16_t num_sample, mpu6050_raw_sample_t *samples)
+{
+	/* Check if pointer data is NULL */
+	if ((data == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint16_t i = 0; i < num_sample; i++)
+	{
+		const uint8_t *sample_data = &data[i * MPU6050_FIFO_SAMPLE_SIZE];
+		mpu6050_decode_sample(&sample_data[0], &sample_data[6], &samples[i]);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_fifo_enable_seq(const mpu6050_reg_write_t **seq, uint8_t *len)
+{
+	/* Check if pointer data is NULL */
+	if ((seq == NULL) || (len == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*seq = fifo_enable_seq;
+	*len = sizeof(fifo_enable_seq) / sizeof(fifo_enable_seq[0]);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_enable_fifo(mpu6050_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err = mpu6050_write_regs(handle, fifo_enable_seq, sizeof(fifo_enable_seq) / sizeof(fifo_enable_seq[0]));
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	handle->fifo_en = 1;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_disable_fifo(mpu6050_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	err_code_t err;
+	uint8_t buffer = 0;
+
+	err = handle->i2c_send(MPU6050_USER_CTRL, &buffer, 1);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	err = handle->i2c_send(MPU6050_FIFO_EN, &buffer, 1);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	handle->fifo_en = 0;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_read_fifo(mpu6050_handle_t handle, mpu6050_raw_sample_t *samples, uint16_t max_sample, uint16_t *num_sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL) || (num_sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*num_sample = 0;
+
+	err_code_t err;
+	uint8_t count_data[2];
+	err = handle->i2c_recv(MPU6050_FIFO_COUNTH, count_data, 2);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	uint16_t num = 0;
+	err = mpu6050_parse_fifo_count(count_data, max_sample, &num);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		mpu6050_enable_fifo(handle);
+		return err;
+	}
+
+	uint8_t fifo_data[MPU6050_FIFO_READ_SAMPLE_MAX * MPU6050_FIFO_SAMPLE_SIZE];
+	while (*num_sample < num)
+	{
+		uint16_t chunk = num - *num_sample;
+		if (chunk > MPU6050_FIFO_READ_SAMPLE_MAX)
+		{
+			chunk = MPU6050_FIFO_READ_SAMPLE_MAX;
+		}
+
+		err = handle->i2c_recv(MPU6050_FIRO_R_W, fifo_data, chunk * MPU6050_FIFO_SAMPLE_SIZE);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			return err;
+		}
+
+		mpu6050_parse_fifo(fifo_data, chunk, &samples[*num_sample]);
+
+		*num_sample += chunk;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t mpu6050_self_test_setup(mpu6050_handle_t handle, uint8_t st_en)
+{
+	err_code_t err;
+	uint8_t buffer = 0;
+
+	/* 1 kHz sample rate with 184 Hz DLPF */
+	buffer = 0x00;
+	err = handle->i2c_send(MPU6050_SMPLRT_DIV, &buffer, 1);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	buffer = MPU6050_184ACCEL_188GYRO_BW_HZ;
+	err = handle->i2c_send(MPU6050_CONFIG, &buffer, 1);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	/* Factory trim is given for 250 deg/s and 8g, self-test on all axes */
+	buffer = st_en ? 0xE0 : 0x00;
+	buffer |= (MPU6050_GFS_SEL_250 << 3) & 0x18;
+	err = handle->i2c_send(MPU6050_GYRO_CONFIG, &buffer, 1);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	buffer = st_en ? 0xE0 : 0x00;
+	buffer |= (MPU6050_AFS_SEL_8G << 3) & 0x18;
+	return handle->i2c_send(MPU6050_ACCEL_CONFIG, &buffer, 1);
+}
+
+static err_code_t mpu6050_self_test_freeze(mpu6050_handle_t handle)
+{
+	/* Stop loading samples, FIFO keeps its content and stays readable */
+	uint8_t buffer = 0x00;
+	return handle->i2c_send(MPU6050_FIFO_EN, &buffer, 1);
+}
+
+static err_code_t mpu6050_self_test_collect(mpu6050_handle_t handle, float accel_mean[3], float gyro_mean[3])
+{
+	err_code_t err;
+	uint8_t count_data[2];
+	err = handle->i2c_recv(MPU6050_FIFO_COUNTH, count_data, 2);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	/* FIFO is frozen, so the count read once is all there is to drain */
+	uint16_t total = 0;
+	err = mpu6050_parse_fifo_count(count_data, SELF_TEST_SAMPLE_MAX, &total);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	if (total == 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint8_t fifo_data[MPU6050_FIFO_READ_SAMPLE_MAX * MPU6050_FIFO_SAMPLE_SIZE];
+	mpu6050_raw_sample_t samples[MPU6050_FIFO_READ_SAMPLE_MAX];
+	int32_t accel_sum[3] = {0}, gyro_sum[3] = {0};
+	uint16_t done = 0;
+
+	while (done < total)
+	{
+		uint16_t chunk = total - done;
+		if (chunk > MPU6050_FIFO_READ_SAMPLE_MAX)
+		{
+			chunk = MPU6050_FIFO_READ_SAMPLE_MAX;
+		}
+
+		err = handle->i2c_recv(MPU6050_FIRO_R_W, fifo_data, chunk * MPU6050_FIFO_SAMPLE_SIZE);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			return err;
+		}
+
+		mpu6050_parse_fifo(fifo_data, chunk, samples);
+
+		for (uint16_t n = 0; n < chunk; n++)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				accel_sum[i] += samples[n].accel[i];
+				gyro_sum[i] += samples[n].gyro[i];
+			}
+		}
+		done += chunk;
+	}
+
+	for (int i = 0; i < 3; i++)
+	{
+		accel_mean[i] = (float)accel_sum[i] / total;
+		gyro_mean[i] = (float)gyro_sum[i] / total;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+static err_code_t mpu6050_self_test_evaluate(mpu6050_handle_t handle, const float accel_str[3], const float gyro_str[3], mpu6050_self_test_report_t *report)
+{
+	uint8_t trim[4];
+	err_code_t err = handle->i2c_recv(MPU6050_SELF_TEST_X, trim, 4);
+	if (err != ERR_CODE_SUCCESS)
+	{
+		return err;
+	}
+
+	report->pass = 1;
+
+	for (int i = 0; i < 3; i++)
+	{
+		/* Accelerometer trim is 3 high bits in SELF_TEST_X/Y/Z and 2 low bits in SELF_TEST_A */
+		uint8_t accel_test = ((trim[i] >> 3) & 0x1C) | ((trim[3] >> (4 - 2 * i)) & 0x03);
+		uint8_t gyro_test = trim[i] & 0x1F;
+
+		float accel_ft = 0.0f;
+		if (accel_test != 0)
+		{
+			accel_ft = 4096.0f * 0.34f * powf(0.92f / 0.34f, (accel_test - 1) / 30.0f);
+		}
+
+		float gyro_ft = 0.0f;
+		if (gyro_test != 0)
+		{
+			gyro_ft = 25.0f * 131.0f * powf(1.046f, gyro_test - 1);
+			if (i == 1)
+			{
+				gyro_ft = -gyro_ft;
+			}
+		}
+
+		report->accel_change[i] = (accel_ft != 0.0f) ? (accel_str[i] - accel_ft) / accel_ft * 100.0f : 0.0f;
+		report->gyro_change[i] = (gyro_ft != 0.0f) ? (gyro_str[i] - gyro_ft) / gyro_ft * 100.0f : 0.0f;
+		report->accel_pass[i] = (accel_ft != 0.0f) && (fabsf(report->accel_change[i]) <= MPU6050_SELF_TEST_LIMIT);
+		report->gyro_pass[i] = (gyro_ft != 0.0f) && (fabsf(report->gyro_change[i]) <= MPU6050_SELF_TEST_LIMIT);
+
+		if (!report->accel_pass[i] || !report->gyro_pass[i])
+		{
+			report->pass = 0;
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_self_test(mpu6050_handle_t handle, mpu6050_self_test_report_t *report)
+{
+	return mpu6050_self_test_multi(&handle, 1, report);
+}
+
+err_code_t mpu6050_self_test_multi(mpu6050_handle_t *handles, uint8_t num_handle, mpu6050_self_test_report_t *reports)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handles == NULL) || (reports == NULL) || (num_handle == 0))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint8_t d = 0; d < num_handle; d++)
+	{
+		if (handles[d] == NULL)
+		{
+			return ERR_CODE_NULL_PTR;
+		}
+
+		memset(&reports[d], 0, sizeof(mpu6050_self_test_report_t));
+	}
+
+	mpu6050_self_test_state_t *state = calloc(num_handle, sizeof(mpu6050_self_test_state_t));
+	if (state == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	for (uint8_t d = 0; d < num_handle; d++)
+	{
+		state[d].fifo_en = handles[d]->fifo_en;
+	}
+
+	/* Phase 0 with self-test disabled, phase 1 enabled. Each step runs on all
+	 * devices before the shared delay, so devices settle and sample together.
+	 */
+	for (uint8_t st_en = 0; st_en < 2; st_en++)
+	{
+		for (uint8_t d = 0; d < num_handle; d++)
+		{
+			if (reports[d].err == ERR_CODE_SUCCESS)
+			{
+				reports[d].err = mpu6050_self_test_setup(handles[d], st_en);
+			}
+		}
+		handles[0]->delay(MPU6050_SELF_TEST_SETTLE_MS);
+
+		/* FIFO reset discards samples taken while settling */
+		for (uint8_t d = 0; d < num_handle; d++)
+		{
+			if (reports[d].err == ERR_CODE_SUCCESS)
+			{
+				reports[d].err = mpu6050_enable_fifo(handles[d]);
+			}
+		}
+		handles[0]->delay(MPU6050_SELF_TEST_SAMPLE_MS);
+
+		/* Freeze all FIFOs before draining any, so no device keeps filling
+		 * its FIFO while the others are read.
+		 */
+		for (uint8_t d = 0; d < num_handle; d++)
+		{
+			if (reports[d].err == ERR_CODE_SUCCESS)
+			{
+				reports[d].err = mpu6050_self_test_freeze(handles[d]);
+			}
+		}
+
+		for (uint8_t d = 0; d < num_handle; d++)
+		{
+			if (reports[d].err == ERR_CODE_SUCCESS)
+			{
+				reports[d].err = mpu6050_self_test_collect(handles[d], state[d].accel_mean[st_en], state[d].gyro_mean[st_en]);
+			}
+		}
+	}
+
+	for (uint8_t d = 0; d < num_handle; d++)
+	{
+		if (reports[d].err == ERR_CODE_SUCCESS)
+		{
+			/* Self-test response is the difference between enabled and disabled output */
+			float accel_str[3], gyro_str[3];
+			for (int i = 0; i < 3; i++)
+			{
+				accel_str[i] = state[d].accel_mean[1][i] - state[d].accel_mean[0][i];
+				gyro_str[i] = state[d].gyro_mean[1][i] - state[d].gyro_mean[0][i];
+			}
+			reports[d].err = mpu6050_self_test_evaluate(handles[d], accel_str, gyro_str, &reports[d]);
+		}
+
+	}
+
+	/* Restore user configuration and FIFO state, same steps as mpu6050_config
+	 * with delays shared by all devices. A device whose restore fails reports
+	 * the error.
+	 */
+	for (uint8_t d = 0; d < num_handle; d++)
+	{
+		handles[d]->fifo_en = state[d].fifo_en;
+		state[d].restore_err = mpu6050_config_reset(handles[d]);
+	}
+	handles[0]->delay(CONFIG_STEP_DELAY_MS);
+
+	for (uint8_t d = 0; d < num_handle; d++)
+	{
+		if (state[d].restore_err == ERR_CODE_SUCCESS)
+		{
+			state[d].restore_err = mpu6050_config_clock(handles[d]);
+		}
+	}
+	handles[0]->delay(CONFIG_STEP_DELAY_MS);
+
+	err_code_t ret = ERR_CODE_SUCCESS;
+	for (uint8_t d = 0; d < num_handle; d++)
+	{
+		if (state[d].restore_err == ERR_CODE_SUCCESS)
+		{
+			state[d].restore_err = mpu6050_config_apply(handles[d]);
+		}
+
+		if ((reports[d].err == ERR_CODE_SUCCESS) && (state[d].restore_err != ERR_CODE_SUCCESS))
+		{
+			reports[d].err = state[d].restore_err;
+		}
+
+		if (reports[d].err != ERR_CODE_SUCCESS)
+		{
+			reports[d].pass = 0;
+			ret = ERR_CODE_FAIL;
+		}
+	}
+
+	free(state);
+
+	return ret;
+}
+
+err_code_t mpu6050_set_accel_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t model)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->accel_model = model;
+
+	mpu6050_update_coef(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_set_gyro_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t model)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->gyro_model = model;
+
+	mpu6050_update_coef(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_accel_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t *model)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (model == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*model = handle->accel_model;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_get_gyro_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t *model)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (model == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	*model = handle->gyro_model;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_fit_accel_calib_model(mpu6050_handle_t handle, const float *pose_mean)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (pose_mean == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Bias compensated scaled data of each pose, extended with 1 for the offset term */
+	float u[MPU6050_POSE_MAX][4];
+	for (int p = 0; p < MPU6050_POSE_MAX; p++)
+	{
+		u[p][0] = (pose_mean[p * 3 + 0] - handle->accel_bias_x) * handle->accel_scaling_factor;
+		u[p][1] = (pose_mean[p * 3 + 1] - handle->accel_bias_y) * handle->accel_scaling_factor;
+		u[p][2] = (pose_mean[p * 3 + 2] - handle->accel_bias_z) * handle->accel_scaling_factor;
+		u[p][3] = 1.0f;
+	}
+
+	/* Normal equations (U^T * U) * x = U^T * t, one right hand side per output axis.
+	 * Reference of pose p is +1g or -1g on axis p / 2.
+	 */
+	float a[4][4 + 3] = {0};
+	for (int p = 0; p < MPU6050_POSE_MAX; p++)
+	{
+		float ref = (p % 2 == 0) ? 1.0f : -1.0f;
+
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				a[i][j] += u[p][i] * u[p][j];
+			}
+			a[i][4 + p / 2] += u[p][i] * ref;
+		}
+	}
+
+	/* Gauss-Jordan elimination with partial pivoting */
+	for (int col = 0; col < 4; col++)
+	{
+		int pivot = col;
+		for (int row = col + 1; row < 4; row++)
+		{
+			if (fabsf(a[row][col]) > fabsf(a[pivot][col]))
+			{
+				pivot = row;
+			}
+		}
+
+		if (fabsf(a[pivot][col]) < 1e-12f)
+		{
+			return ERR_CODE_FAIL;
+		}
+
+		if (pivot != col)
+		{
+			for (int j = 0; j < 4 + 3; j++)
+			{
+				float tmp = a[col][j];
+				a[col][j] = a[pivot][j];
+				a[pivot][j] = tmp;
+			}
+		}
+
+		for (int row = 0; row < 4; row++)
+		{
+			if (row == col)
+			{
+				continue;
+			}
+
+			float factor = a[row][col] / a[col][col];
+			for (int j = col; j < 4 + 3; j++)
+			{
+				a[row][j] -= factor * a[col][j];
+			}
+		}
+	}
+
+	/* Column k of the solution is row k of the model */
+	for (int k = 0; k < 3; k++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			handle->accel_model.matrix[k][j] = a[j][4 + k] / a[j][j];
+		}
+		handle->accel_model.offset[k] = a[3][4 + k] / a[3][3];
+	}
+
+	mpu6050_update_coef(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_convert_batch(mpu6050_handle_t handle, const mpu6050_raw_sample_t *raw, mpu6050_scale_sample_t *scale, uint32_t num_sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (raw == NULL) || (scale == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Work on blocks in structure of arrays layout so the per axis multiply-add
+	 * kernel vectorizes; the copies in and out of the interleaved samples stay scalar.
+	 */
+	float accel_in[3][CONVERT_BLOCK_SIZE], gyro_in[3][CONVERT_BLOCK_SIZE];
+	float accel_out[3][CONVERT_BLOCK_SIZE], gyro_out[3][CONVERT_BLOCK_SIZE];
+
+	for (uint32_t base = 0; base < num_sample; base += CONVERT_BLOCK_SIZE)
+	{
+		uint32_t num = num_sample - base;
+		if (num > CONVERT_BLOCK_SIZE)
+		{
+			num = CONVERT_BLOCK_SIZE;
+		}
+
+		const mpu6050_raw_sample_t *in = &raw[base];
+		for (uint32_t n = 0; n < num; n++)
+		{
+			accel_in[0][n] = in[n].accel[0];
+			accel_in[1][n] = in[n].accel[1];
+			accel_in[2][n] = in[n].accel[2];
+			gyro_in[0][n] = in[n].gyro[0];
+			gyro_in[1][n] = in[n].gyro[1];
+			gyro_in[2][n] = in[n].gyro[2];
+		}
+
+		mpu6050_apply_coef_block(handle->accel_coef, handle->accel_coef_offset, accel_in, accel_out, num);
+		mpu6050_apply_coef_block(handle->gyro_coef, handle->gyro_coef_offset, gyro_in, gyro_out, num);
+
+		mpu6050_scale_sample_t *out = &scale[base];
+		for (uint32_t n = 0; n < num; n++)
+		{
+			out[n].accel[0] = accel_out[0][n];
+			out[n].accel[1] = accel_out[1][n];
+			out[n].accel[2] = accel_out[2][n];
+			out[n].gyro[0] = gyro_out[0][n];
+			out[n].gyro[1] = gyro_out[1][n];
+			out[n].gyro[2] = gyro_out[2][n];
+		}
+	}
+
 	return ERR_CODE_SUCCESS;
 }
@@ -31,6 +31,19 @@ extern "C" {
 
 #define MPU6050_I2C_ADDR		(0x68)
 
+#define MPU6050_BURST_REG               0x3B        /*!< Burst read start register, accelerometer x axis high byte */
+#define MPU6050_BURST_SIZE              14          /*!< Burst read size, accelerometer, temperature and gyroscope */
+#define MPU6050_FIFO_COUNT_REG          0x72        /*!< FIFO count register, high byte first */
+#define MPU6050_FIFO_COUNT_SIZE         2           /*!< FIFO count size in bytes */
+#define MPU6050_FIFO_DATA_REG           0x74        /*!< FIFO read write register */
+#define MPU6050_FIFO_SIZE               1024        /*!< FIFO size in bytes */
+#define MPU6050_FIFO_SAMPLE_SIZE        12          /*!< Accelerometer and gyroscope bytes per FIFO sample */
+#define MPU6050_FIFO_READ_SAMPLE_MAX    16          /*!< Number of samples per FIFO read transaction */
+
+#define MPU6050_SELF_TEST_LIMIT         14.0f       /*!< Self-test pass limit of change from factory trim (%) */
+#define MPU6050_SELF_TEST_SETTLE_MS     50          /*!< Self-test settle time after each configuration change */
+#define MPU6050_SELF_TEST_SAMPLE_MS     50          /*!< Self-test averaging time, 1 kHz samples into FIFO */
+
 typedef err_code_t (*mpu6050_func_i2c_send)(uint8_t reg_addr, uint8_t *buf_send, uint16_t len);
 typedef err_code_t (*mpu6050_func_i2c_recv)(uint8_t reg_addr, uint8_t *buf_recv, uint16_t len);
 typedef void (*mpu6050_func_delay)(uint32_t ms);
@@ -101,6 +114,14 @@ typedef enum {
 
 /**
  * @brief   Configuration structure.
+ *
+ * @note    Sample rate is gyroscope output rate / (1 + divider), see
+ *          mpu6050_set_sample_rate_div. Gyroscope output rate is 8 kHz with
+ *          DLPF 260 Hz and 1 kHz with the other DLPF settings. The sample
+ *          rate feeds data registers and FIFO, and is the input rate of
+ *          mpu6050_multirate, whose outputs run at sample rate / decim.
+ *          E.g. divider 0 with DLPF 184 Hz gives 1 kHz, and decim 10 and 100
+ *          give 100 Hz and 10 Hz.
  */
 typedef struct {
 	mpu6050_clksel_t        	clksel;         			/*!< MPU6050 clock source */
@@ -119,6 +140,71 @@ typedef struct {
 	mpu6050_func_delay          delay;                 		/*!< MPU6050 delay function */
 } mpu6050_cfg_t;
 
+/**
+ * @brief   Raw sample of accelerometer and gyroscope.
+ */
+typedef struct {
+	int16_t                     accel[3];                   /*!< Accelerometer raw value x, y, z axis */
+	int16_t                     gyro[3];                    /*!< Gyroscope raw value x, y, z axis */
+} mpu6050_raw_sample_t;
+
+/**
+ * @brief   Scaled sample of accelerometer and gyroscope.
+ */
+typedef struct {
+	float                       accel[3];                   /*!< Accelerometer scaled data x, y, z axis (g) */
+	float                       gyro[3];                    /*!< Gyroscope scaled data x, y, z axis (deg/s) */
+} mpu6050_scale_sample_t;
+
+/**
+ * @brief   Affine calibration model.
+ *
+ * @note    Calibrated data = matrix * scaled data + offset, where scaled data
+ *          is already bias compensated. The identity matrix with zero offset
+ *          leaves scaled data unchanged.
+ */
+typedef struct {
+	float                       matrix[3][3];               /*!< Misalignment and scale factor matrix */
+	float                       offset[3];                  /*!< Offset x, y, z axis (scaled unit) */
+} mpu6050_calib_model_t;
+
+/**
+ * @brief   Register write.
+ */
+typedef struct {
+	uint8_t                     reg_addr;                   /*!< Register address */
+	uint8_t                     data;                       /*!< Data to write */
+} mpu6050_reg_write_t;
+
+/**
+ * @brief   Self-test report.
+ *
+ * @note    Change is the self-test response deviation from factory trim in
+ *          percent. An axis passes within +/- MPU6050_SELF_TEST_LIMIT. An
+ *          axis with no factory trim fails.
+ */
+typedef struct {
+	err_code_t                  err;                        /*!< Bus error during self-test */
+	float                       accel_change[3];            /*!< Accelerometer change x, y, z axis (%) */
+	float                       gyro_change[3];             /*!< Gyroscope change x, y, z axis (%) */
+	uint8_t                     accel_pass[3];              /*!< Accelerometer x, y, z axis passed */
+	uint8_t                     gyro_pass[3];               /*!< Gyroscope x, y, z axis passed */
+	uint8_t                     pass;                       /*!< No bus error and all axes passed */
+} mpu6050_self_test_report_t;
+
+/**
+ * @brief   Calibration pose, named by the axis pointing up.
+ */
+typedef enum {
+	MPU6050_POSE_X_UP = 0,                  /*!< X axis up */
+	MPU6050_POSE_X_DOWN,                    /*!< X axis down */
+	MPU6050_POSE_Y_UP,                      /*!< Y axis up */
+	MPU6050_POSE_Y_DOWN,                    /*!< Y axis down */
+	MPU6050_POSE_Z_UP,                      /*!< Z axis up */
+	MPU6050_POSE_Z_DOWN,                    /*!< Z axis down */
+	MPU6050_POSE_MAX
+} mpu6050_pose_t;
+
 /*
  * @brief   Initialize MPU6050 with default parameters.
  *
@@ -172,6 +258,9 @@ err_code_t mpu6050_get_accel_raw(mpu6050_handle_t handle, int16_t *raw_x, int16_
 /*
  * @brief   Get accelerometer calibrated data.
  *
+ * @note    Only bias is removed, in raw unit. The calibration model is
+ *          applied by mpu6050_get_accel_scale and mpu6050_convert_batch.
+ *
  * @param   handle Handle structure.
  * @param   calib_x Calibrated data x axis.
  * @param   calib_y Calibrated data y axis.
@@ -214,6 +303,9 @@ err_code_t mpu6050_get_gyro_raw(mpu6050_handle_t handle, int16_t *raw_x, int16_t
 /*
  * @brief   Get gyroscope calibrated data.
  *
+ * @note    Only bias is removed, in raw unit. The calibration model is
+ *          applied by mpu6050_get_gyro_scale and mpu6050_convert_batch.
+ *
  * @param   handle Handle structure.
  * @param   calib_x Calibrated data x axis.
  * @param   calib_y Calibrated data y axis.
@@ -267,6 +359,21 @@ err_code_t mpu6050_set_accel_bias(mpu6050_handle_t handle, int16_t bias_x, int16
  */
 err_code_t mpu6050_set_gyro_bias(mpu6050_handle_t handle, int16_t bias_x, int16_t bias_y, int16_t bias_z);
 
+/*
+ * @brief   Set sample rate divider.
+ *
+ * @note    Sample rate is gyroscope output rate / (1 + smplrt_div). Default
+ *          divider is 4. Takes effect on the next mpu6050_config.
+ *
+ * @param   handle Handle structure.
+ * @param   smplrt_div Sample rate divider.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_sample_rate_div(mpu6050_handle_t handle, uint8_t smplrt_div);
+
 /*
  * @brief   Get accelerometer bias data.
  *
@@ -306,6 +413,241 @@ err_code_t mpu6050_get_gyro_bias(mpu6050_handle_t handle, int16_t *bias_x, int16
  */
 err_code_t mpu6050_auto_calib(mpu6050_handle_t handle);
 
+/*
+ * @brief   Get accelerometer and gyroscope raw value in one burst read.
+ *
+ * @param   handle Handle structure.
+ * @param   sample Raw sample.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_raw_sample(mpu6050_handle_t handle, mpu6050_raw_sample_t *sample);
+
+/*
+ * @brief   Parse a burst read into a raw sample.
+ *
+ * @param   data MPU6050_BURST_SIZE bytes read from MPU6050_BURST_REG.
+ * @param   sample Raw sample.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_parse_burst(const uint8_t *data, mpu6050_raw_sample_t *sample);
+
+/*
+ * @brief   Parse FIFO count into number of samples to read.
+ *
+ * @note    Returns ERR_CODE_FAIL on FIFO overflow, in which case FIFO must be
+ *          reset with the sequence of mpu6050_get_fifo_enable_seq.
+ *
+ * @param   data MPU6050_FIFO_COUNT_SIZE bytes read from MPU6050_FIFO_COUNT_REG.
+ * @param   max_sample Maximum number of samples to read.
+ * @param   num_sample Number of samples to read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_parse_fifo_count(const uint8_t *data, uint16_t max_sample, uint16_t *num_sample);
+
+/*
+ * @brief   Parse FIFO data into raw samples.
+ *
+ * @param   data num_sample * MPU6050_FIFO_SAMPLE_SIZE bytes read from MPU6050_FIFO_DATA_REG.
+ * @param   num_sample Number of samples.
+ * @param   samples Raw samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_parse_fifo(const uint8_t *data, uint16_t num_sample, mpu6050_raw_sample_t *samples);
+
+/*
+ * @brief   Get register writes that reset and enable FIFO.
+ *
+ * @note    Used by mpu6050_enable_fifo. Exposed for non-blocking transports.
+ *
+ * @param   seq Register writes, in order.
+ * @param   len Number of register writes.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_fifo_enable_seq(const mpu6050_reg_write_t **seq, uint8_t *len);
+
+/*
+ * @brief   Enable FIFO for accelerometer and gyroscope data.
+ *
+ * @note    FIFO is filled at the sample rate. It is reset when enabled and
+ *          re-enabled by mpu6050_config.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_enable_fifo(mpu6050_handle_t handle);
+
+/*
+ * @brief   Disable FIFO.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_disable_fifo(mpu6050_handle_t handle);
+
+/*
+ * @brief   Read raw samples from FIFO.
+ *
+ * @note    On FIFO overflow, FIFO is reset and ERR_CODE_FAIL is returned
+ *          since sample boundaries are lost.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Raw samples.
+ * @param   max_sample Maximum number of samples to read.
+ * @param   num_sample Number of samples read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_read_fifo(mpu6050_handle_t handle, mpu6050_raw_sample_t *samples, uint16_t max_sample, uint16_t *num_sample);
+
+/*
+ * @brief   Run hardware self-test.
+ *
+ * @note    Same as mpu6050_self_test_multi with one device.
+ *
+ * @param   handle Handle structure.
+ * @param   report Self-test report.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_self_test(mpu6050_handle_t handle, mpu6050_self_test_report_t *report);
+
+/*
+ * @brief   Run hardware self-test on several devices in parallel.
+ *
+ * @note    All axes of all devices are tested at once. Responses are
+ *          averaged from FIFO with self-test disabled and enabled, then
+ *          compared to the factory trim. Each device is then reset and
+ *          reconfigured as by mpu6050_config. Every device waits on the
+ *          same delays, and all FIFOs are frozen at the end of the sample
+ *          time before any is drained, so a device never overflows while
+ *          others are read. Delays total
+ *          2 * (MPU6050_SELF_TEST_SETTLE_MS + MPU6050_SELF_TEST_SAMPLE_MS)
+ *          plus 20 ms for the reconfiguration, 220 ms. Bus traffic is at
+ *          most about 1.7 kB per device, mostly the two FIFO drains of up
+ *          to 64 samples, which is 40 ms at 400 kHz or 160 ms at 100 kHz.
+ *          Worst case is then 220 ms + 40 ms per device at 400 kHz. A
+ *          failed reconfiguration is reported in the device report and the
+ *          return value.
+ *
+ * @param   handles Handle structures, delay of the first one is used.
+ * @param   num_handle Number of handle structures.
+ * @param   reports Self-test report of each device.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Self-test ran on all devices, see reports for result.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_self_test_multi(mpu6050_handle_t *handles, uint8_t num_handle, mpu6050_self_test_report_t *reports);
+
+/*
+ * @brief   Set accelerometer calibration model.
+ *
+ * @param   handle Handle structure.
+ * @param   model Calibration model.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_accel_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t model);
+
+/*
+ * @brief   Set gyroscope calibration model.
+ *
+ * @param   handle Handle structure.
+ * @param   model Calibration model.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_set_gyro_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t model);
+
+/*
+ * @brief   Get accelerometer calibration model.
+ *
+ * @param   handle Handle structure.
+ * @param   model Calibration model.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_accel_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t *model);
+
+/*
+ * @brief   Get gyroscope calibration model.
+ *
+ * @param   handle Handle structure.
+ * @param   model Calibration model.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_get_gyro_calib_model(mpu6050_handle_t handle, mpu6050_calib_model_t *model);
+
+/*
+ * @brief   Fit accelerometer calibration model from six position data and
+ *          apply it.
+ *
+ * @note    Each pose holds the averaged accelerometer raw value while the
+ *          sensor rests with that axis pointing up. The model is solved in
+ *          least squares sense, minimizing the residual from 1g on the up
+ *          axis and 0g on the others over all poses.
+ *
+ * @param   handle Handle structure.
+ * @param   pose_mean Averaged raw value x, y, z axis of each pose, indexed
+ *          pose_mean[pose * 3 + axis] (MPU6050_POSE_MAX * 3 elements).
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_fit_accel_calib_model(mpu6050_handle_t handle, const float *pose_mean);
+
+/*
+ * @brief   Convert a batch of raw samples to calibrated scaled data.
+ *
+ * @note    Bias, scaling factor and calibration model are applied in one
+ *          pass over the samples.
+ *
+ * @param   handle Handle structure.
+ * @param   raw Raw samples.
+ * @param   scale Scaled samples.
+ * @param   num_sample Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_convert_batch(mpu6050_handle_t handle, const mpu6050_raw_sample_t *raw, mpu6050_scale_sample_t *scale, uint32_t num_sample);
+
 
 #ifdef __cplusplus
 }
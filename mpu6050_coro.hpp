@@ -0,0 +1,772 @@
+// MIT License
+
+// Copyright (c) 2024 phonght32
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __MPU6050_CORO_HPP__
+#define __MPU6050_CORO_HPP__
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <type_traits>
+#include <span>
+#include <utility>
+
+#include "mpu6050.h"
+
+namespace mpu6050_coro {
+
+/**
+ * @brief   Completion callback of a non-blocking transfer.
+ */
+using completion_fn = void (*)(void *ctx, err_code_t err);
+
+/**
+ * @brief   Non-blocking register transport.
+ *
+ * @note    A transfer starts and returns at once. The callback runs once
+ *          the transfer is done, from any context. The buffer stays valid
+ *          until then.
+ */
+class async_transport {
+public:
+	virtual void start_send(uint8_t reg_addr, const uint8_t *buf_send, uint16_t len, completion_fn cb, void *ctx) = 0;
+	virtual void start_recv(uint8_t reg_addr, uint8_t *buf_recv, uint16_t len, completion_fn cb, void *ctx) = 0;
+
+protected:
+	~async_transport() = default;
+};
+
+/**
+ * @brief   Executor that resumes coroutines, typically an event loop.
+ *
+ * @note    post is called from the transport completion context, which may
+ *          be another thread or an interrupt handler, so it must be thread
+ *          safe and, on bare metal, interrupt safe. Resuming must happen on
+ *          the executor, never inside post.
+ */
+class executor {
+public:
+	virtual void post(std::coroutine_handle<> h) = 0;
+	virtual void post_after(uint32_t ms, std::coroutine_handle<> h) = 0;
+
+protected:
+	~executor() = default;
+};
+
+/**
+ * @brief   Bytes reserved in front of each coroutine frame to remember its
+ *          allocator, keeping the frame at the default new alignment.
+ */
+constexpr std::size_t FRAME_HEADER_SIZE = (sizeof(void *) + __STDCPP_DEFAULT_NEW_ALIGNMENT__ - 1) /
+                                          __STDCPP_DEFAULT_NEW_ALIGNMENT__ * __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+/**
+ * @brief   Coroutine frame allocator.
+ *
+ * @note    Returned memory must be aligned to __STDCPP_DEFAULT_NEW_ALIGNMENT__.
+ */
+class frame_allocator {
+public:
+	virtual void *allocate(std::size_t size) noexcept = 0;
+	virtual void deallocate(void *ptr, std::size_t size) noexcept = 0;
+
+protected:
+	~frame_allocator() = default;
+};
+
+/**
+ * @brief   Frame allocator on the global heap.
+ */
+class heap_frame_allocator final : public frame_allocator {
+public:
+	void *allocate(std::size_t size) noexcept override
+	{
+		return ::operator new(size, std::nothrow);
+	}
+
+	void deallocate(void *ptr, std::size_t) noexcept override
+	{
+		::operator delete(ptr);
+	}
+};
+
+/**
+ * @brief   Frame allocator with a fixed number of fixed size blocks.
+ *
+ * @note    Not thread safe. Use one per executor thread. BlockSize must
+ *          hold the largest frame plus FRAME_HEADER_SIZE.
+ */
+template <std::size_t BlockSize, std::size_t NumBlocks>
+class pool_frame_allocator final : public frame_allocator {
+public:
+	pool_frame_allocator() noexcept
+	{
+		for (std::size_t i = 0; i < NumBlocks; i++)
+		{
+			blocks_[i].next = (i + 1 < NumBlocks) ? &blocks_[i + 1] : nullptr;
+		}
+		free_ = &blocks_[0];
+	}
+
+	pool_frame_allocator(const pool_frame_allocator &) = delete;
+	pool_frame_allocator &operator=(const pool_frame_allocator &) = delete;
+
+	void *allocate(std::size_t size) noexcept override
+	{
+		if ((size > BlockSize) || (free_ == nullptr))
+		{
+			return nullptr;
+		}
+
+		block *b = free_;
+		free_ = b->next;
+		return b->data;
+	}
+
+	void deallocate(void *ptr, std::size_t) noexcept override
+	{
+		block *b = reinterpret_cast<block *>(ptr);
+		b->next = free_;
+		free_ = b;
+	}
+
+private:
+	union block {
+		block *next;
+		alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) unsigned char data[BlockSize];
+	};
+
+	block blocks_[NumBlocks];
+	block *free_;
+};
+
+/*
+ * @brief   Get frame allocator used by new coroutines on the calling thread.
+ */
+inline frame_allocator *&current_frame_allocator() noexcept
+{
+	static heap_frame_allocator heap;
+	thread_local frame_allocator *current = &heap;
+	return current;
+}
+
+/*
+ * @brief   Set frame allocator used by new coroutines on the calling thread.
+ *
+ * @note    The allocator must outlive every coroutine allocated from it.
+ *          Other threads keep their own allocator.
+ */
+inline void set_frame_allocator(frame_allocator &allocator) noexcept
+{
+	current_frame_allocator() = &allocator;
+}
+
+namespace detail {
+
+/* Frames remember their allocator so it may change between creation and destruction,
+ * or the frame may be destroyed on another thread.
+ */
+struct promise_base {
+	static void *operator new(std::size_t size) noexcept
+	{
+		frame_allocator *allocator = current_frame_allocator();
+		void *ptr = allocator->allocate(size + FRAME_HEADER_SIZE);
+		if (ptr == nullptr)
+		{
+			return nullptr;
+		}
+
+		*static_cast<frame_allocator **>(ptr) = allocator;
+		return static_cast<unsigned char *>(ptr) + FRAME_HEADER_SIZE;
+	}
+
+	static void operator delete(void *ptr, std::size_t size) noexcept
+	{
+		void *base = static_cast<unsigned char *>(ptr) - FRAME_HEADER_SIZE;
+		(*static_cast<frame_allocator **>(base))->deallocate(base, size + FRAME_HEADER_SIZE);
+	}
+
+	void unhandled_exception() noexcept
+	{
+		std::terminate();
+	}
+};
+
+template <typename T>
+T make_failure() noexcept
+{
+	if constexpr (std::is_same_v<T, err_code_t>)
+	{
+		return ERR_CODE_FAIL;
+	}
+	else
+	{
+		T result{};
+		result.err = ERR_CODE_FAIL;
+		return result;
+	}
+}
+
+} /* namespace detail */
+
+/**
+ * @brief   Lazy coroutine returning T.
+ *
+ * @note    T is err_code_t or a result with an err member, so that a task
+ *          whose frame allocation failed yields ERR_CODE_FAIL.
+ */
+template <typename T>
+class [[nodiscard]] task {
+public:
+	struct promise_type : detail::promise_base {
+		T value{};
+		std::coroutine_handle<> continuation;
+		bool detached = false;
+
+		static task get_return_object_on_allocation_failure() noexcept
+		{
+			return task();
+		}
+
+		task get_return_object() noexcept
+		{
+			return task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		struct final_awaiter {
+			bool await_ready() noexcept
+			{
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+			{
+				promise_type &p = h.promise();
+				if (p.continuation)
+				{
+					return p.continuation;
+				}
+				if (p.detached)
+				{
+					h.destroy();
+				}
+				return std::noop_coroutine();
+			}
+
+			void await_resume() noexcept
+			{
+			}
+		};
+
+		final_awaiter final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_value(T v) noexcept
+		{
+			value = std::move(v);
+		}
+	};
+
+	task() noexcept = default;
+
+	task(task &&other) noexcept : h_(std::exchange(other.h_, {}))
+	{
+	}
+
+	task &operator=(task &&other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			h_ = std::exchange(other.h_, {});
+		}
+		return *this;
+	}
+
+	~task()
+	{
+		reset();
+	}
+
+	bool valid() const noexcept
+	{
+		return static_cast<bool>(h_);
+	}
+
+	/*
+	 * @brief   Start the task without awaiting it. The frame frees itself
+	 *          when the task finishes.
+	 */
+	void detach(executor &exec) noexcept
+	{
+		if (!h_)
+		{
+			return;
+		}
+
+		h_.promise().detached = true;
+		exec.post(std::exchange(h_, {}));
+	}
+
+	auto operator co_await() && noexcept
+	{
+		struct awaiter {
+			std::coroutine_handle<promise_type> h;
+
+			bool await_ready() noexcept
+			{
+				return !h;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+			{
+				h.promise().continuation = caller;
+				return h;
+			}
+
+			T await_resume() noexcept
+			{
+				if (!h)
+				{
+					return detail::make_failure<T>();
+				}
+				return std::move(h.promise().value);
+			}
+		};
+
+		return awaiter{h_};
+	}
+
+private:
+	explicit task(std::coroutine_handle<promise_type> h) noexcept : h_(h)
+	{
+	}
+
+	void reset() noexcept
+	{
+		if (h_)
+		{
+			h_.destroy();
+			h_ = {};
+		}
+	}
+
+	std::coroutine_handle<promise_type> h_;
+};
+
+/**
+ * @brief   Asynchronous generator of T.
+ *
+ * @note    Consumer calls co_await next() until it returns nullptr. The
+ *          yielded value is valid until the next call.
+ */
+template <typename T>
+class [[nodiscard]] async_generator {
+public:
+	struct promise_type : detail::promise_base {
+		const T *current = nullptr;
+		std::coroutine_handle<> consumer;
+
+		static async_generator get_return_object_on_allocation_failure() noexcept
+		{
+			return async_generator();
+		}
+
+		async_generator get_return_object() noexcept
+		{
+			return async_generator(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		struct yield_awaiter {
+			bool await_ready() noexcept
+			{
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+			{
+				return h.promise().consumer;
+			}
+
+			void await_resume() noexcept
+			{
+			}
+		};
+
+		yield_awaiter yield_value(const T &v) noexcept
+		{
+			current = &v;
+			return {};
+		}
+
+		yield_awaiter final_suspend() noexcept
+		{
+			current = nullptr;
+			return {};
+		}
+
+		void return_void() noexcept
+		{
+		}
+	};
+
+	async_generator() noexcept = default;
+
+	async_generator(async_generator &&other) noexcept : h_(std::exchange(other.h_, {}))
+	{
+	}
+
+	async_generator &operator=(async_generator &&other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+			h_ = std::exchange(other.h_, {});
+		}
+		return *this;
+	}
+
+	~async_generator()
+	{
+		reset();
+	}
+
+	bool valid() const noexcept
+	{
+		return static_cast<bool>(h_);
+	}
+
+	/*
+	 * @brief   Resume the generator until it yields or finishes.
+	 */
+	auto next() noexcept
+	{
+		struct awaiter {
+			std::coroutine_handle<promise_type> h;
+
+			bool await_ready() noexcept
+			{
+				return !h || h.done();
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+			{
+				h.promise().consumer = caller;
+				return h;
+			}
+
+			const T *await_resume() noexcept
+			{
+				return (h && !h.done()) ? h.promise().current : nullptr;
+			}
+		};
+
+		return awaiter{h_};
+	}
+
+private:
+	explicit async_generator(std::coroutine_handle<promise_type> h) noexcept : h_(h)
+	{
+	}
+
+	void reset() noexcept
+	{
+		if (h_)
+		{
+			h_.destroy();
+			h_ = {};
+		}
+	}
+
+	std::coroutine_handle<promise_type> h_;
+};
+
+/**
+ * @brief   Result of a single sample read.
+ */
+struct sample_result {
+	err_code_t                  err;                        /*!< Error code */
+	mpu6050_scale_sample_t      sample;                     /*!< Calibrated scaled sample */
+};
+
+/**
+ * @brief   Result of a FIFO batch read.
+ */
+struct batch_result {
+	err_code_t                  err;                        /*!< Error code */
+	uint16_t                    num_sample;                 /*!< Number of samples read */
+};
+
+/**
+ * @brief   Batch yielded by a sample stream.
+ */
+struct batch {
+	err_code_t                  err;                        /*!< Error code, stream ends after an error */
+	std::span<const mpu6050_scale_sample_t> samples;        /*!< Calibrated scaled samples */
+};
+
+/**
+ * @brief   Awaitable that resumes on the executor after a delay.
+ */
+class sleep_awaiter {
+public:
+	sleep_awaiter(executor &exec, uint32_t ms) noexcept : exec_(exec), ms_(ms)
+	{
+	}
+
+	bool await_ready() noexcept
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> h) noexcept
+	{
+		exec_.post_after(ms_, h);
+	}
+
+	void await_resume() noexcept
+	{
+	}
+
+private:
+	executor &exec_;
+	uint32_t ms_;
+};
+
+/**
+ * @brief   Asynchronous MPU6050 sensor.
+ *
+ * @note    Device configuration and calibration are done through the C API
+ *          on the handle. This class only performs data reads, through the
+ *          non-blocking transport, and resumes on the executor.
+ */
+class sensor {
+public:
+	sensor(mpu6050_handle_t handle, async_transport &transport, executor &exec) noexcept
+		: handle_(handle), transport_(transport), exec_(exec)
+	{
+	}
+
+	executor &get_executor() noexcept
+	{
+		return exec_;
+	}
+
+	/*
+	 * @brief   Read one calibrated sample in a burst read.
+	 */
+	task<sample_result> read_sample()
+	{
+		uint8_t raw_data[MPU6050_BURST_SIZE];
+		err_code_t err = co_await recv(MPU6050_BURST_REG, raw_data, MPU6050_BURST_SIZE);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			co_return sample_result{err, {}};
+		}
+
+		mpu6050_raw_sample_t raw;
+		mpu6050_parse_burst(raw_data, &raw);
+
+		sample_result result{ERR_CODE_SUCCESS, {}};
+		result.err = mpu6050_convert_batch(handle_, &raw, &result.sample, 1);
+		co_return result;
+	}
+
+	/*
+	 * @brief   Read calibrated samples from FIFO.
+	 *
+	 * @note    FIFO must be enabled with mpu6050_enable_fifo. On overflow FIFO
+	 *          is reset and ERR_CODE_FAIL is returned, or the error of the
+	 *          first failed reset write.
+	 */
+	task<batch_result> read_fifo(std::span<mpu6050_scale_sample_t> samples)
+	{
+		uint8_t count_data[MPU6050_FIFO_COUNT_SIZE];
+		err_code_t err = co_await recv(MPU6050_FIFO_COUNT_REG, count_data, MPU6050_FIFO_COUNT_SIZE);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			co_return batch_result{err, 0};
+		}
+
+		uint16_t max_sample = (samples.size() > UINT16_MAX) ? UINT16_MAX : (uint16_t)samples.size();
+		uint16_t num = 0;
+		err = mpu6050_parse_fifo_count(count_data, max_sample, &num);
+		if (err != ERR_CODE_SUCCESS)
+		{
+			const mpu6050_reg_write_t *seq;
+			uint8_t len;
+			mpu6050_get_fifo_enable_seq(&seq, &len);
+			for (uint8_t i = 0; i < len; i++)
+			{
+				uint8_t buffer = seq[i].data;
+				err_code_t send_err = co_await send(seq[i].reg_addr, &buffer, 1);
+				if (send_err != ERR_CODE_SUCCESS)
+				{
+					co_return batch_result{send_err, 0};
+				}
+			}
+			co_return batch_result{err, 0};
+		}
+
+		uint8_t fifo_data[MPU6050_FIFO_READ_SAMPLE_MAX * MPU6050_FIFO_SAMPLE_SIZE];
+		mpu6050_raw_sample_t raw[MPU6050_FIFO_READ_SAMPLE_MAX];
+		uint16_t done = 0;
+		while (done < num)
+		{
+			uint16_t chunk = num - done;
+			if (chunk > MPU6050_FIFO_READ_SAMPLE_MAX)
+			{
+				chunk = MPU6050_FIFO_READ_SAMPLE_MAX;
+			}
+
+			err = co_await recv(MPU6050_FIFO_DATA_REG, fifo_data, chunk * MPU6050_FIFO_SAMPLE_SIZE);
+			if (err != ERR_CODE_SUCCESS)
+			{
+				co_return batch_result{err, done};
+			}
+
+			mpu6050_parse_fifo(fifo_data, chunk, raw);
+			mpu6050_convert_batch(handle_, raw, &samples[done], chunk);
+
+			done += chunk;
+		}
+
+		co_return batch_result{ERR_CODE_SUCCESS, done};
+	}
+
+	/*
+	 * @brief   Stream FIFO batches, polling FIFO every period_ms.
+	 *
+	 * @note    Empty polls are not yielded. The stream ends after yielding
+	 *          an error. An empty buf yields ERR_CODE_INVALID_ARG.
+	 */
+	async_generator<batch> stream_fifo(std::span<mpu6050_scale_sample_t> buf, uint32_t period_ms)
+	{
+		if (buf.empty())
+		{
+			co_yield batch{ERR_CODE_INVALID_ARG, {}};
+			co_return;
+		}
+
+		for (;;)
+		{
+			batch_result result = co_await read_fifo(buf);
+			if (result.err != ERR_CODE_SUCCESS)
+			{
+				co_yield batch{result.err, {}};
+				co_return;
+			}
+
+			if (result.num_sample > 0)
+			{
+				co_yield batch{ERR_CODE_SUCCESS, buf.first(result.num_sample)};
+			}
+
+			/* Drain without waiting while FIFO may still hold data */
+			if (result.num_sample < buf.size())
+			{
+				co_await sleep_awaiter(exec_, period_ms);
+			}
+		}
+	}
+
+private:
+	class transfer_awaiter {
+	public:
+		transfer_awaiter(sensor &s, uint8_t reg_addr, uint8_t *buf, uint16_t len, bool is_send) noexcept
+			: s_(s), reg_addr_(reg_addr), buf_(buf), len_(len), is_send_(is_send)
+		{
+		}
+
+		bool await_ready() noexcept
+		{
+			return false;
+		}
+
+		void await_suspend(std::coroutine_handle<> h) noexcept
+		{
+			h_ = h;
+			if (is_send_)
+			{
+				s_.transport_.start_send(reg_addr_, buf_, len_, &transfer_awaiter::on_done, this);
+			}
+			else
+			{
+				s_.transport_.start_recv(reg_addr_, buf_, len_, &transfer_awaiter::on_done, this);
+			}
+		}
+
+		err_code_t await_resume() noexcept
+		{
+			return err_;
+		}
+
+	private:
+		static void on_done(void *ctx, err_code_t err) noexcept
+		{
+			transfer_awaiter *self = static_cast<transfer_awaiter *>(ctx);
+			self->err_ = err;
+			self->s_.exec_.post(self->h_);
+		}
+
+		sensor &s_;
+		uint8_t reg_addr_;
+		uint8_t *buf_;
+		uint16_t len_;
+		bool is_send_;
+		err_code_t err_ = ERR_CODE_SUCCESS;
+		std::coroutine_handle<> h_;
+	};
+
+	transfer_awaiter send(uint8_t reg_addr, uint8_t *buf_send, uint16_t len) noexcept
+	{
+		return transfer_awaiter(*this, reg_addr, buf_send, len, true);
+	}
+
+	transfer_awaiter recv(uint8_t reg_addr, uint8_t *buf_recv, uint16_t len) noexcept
+	{
+		return transfer_awaiter(*this, reg_addr, buf_recv, len, false);
+	}
+
+	mpu6050_handle_t handle_;
+	async_transport &transport_;
+	executor &exec_;
+};
+
+} /* namespace mpu6050_coro */
+
+#endif /* __MPU6050_CORO_HPP__ */
@@ -0,0 +1,211 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/ioctl.h"
+#include "linux/i2c.h"
+#include "linux/i2c-dev.h"
+#include "mpu6050_i2c_linux.h"
+
+#define MPU6050_I2C_LINUX_XFER_MAX      (I2C_RDWR_IOCTL_MAX_MSGS / 2)   /*!< Register reads per ioctl, 2 messages each */
+
+
+typedef struct mpu6050_i2c_linux {
+	const char                      *dev_path;          /*!< I2C device path */
+	mpu6050_i2c_linux_func_ioctl    ioctl;              /*!< ioctl function */
+	int                             fd;                 /*!< File descriptor */
+	uint32_t                        xfer_max;           /*!< Register reads per ioctl accepted by the adapter */
+} mpu6050_i2c_linux_t;
+
+static int mpu6050_i2c_linux_sys_ioctl(int fd, unsigned long request, void *arg)
+{
+	return ioctl(fd, request, arg);
+}
+
+mpu6050_i2c_linux_handle_t mpu6050_i2c_linux_init(void)
+{
+	mpu6050_i2c_linux_handle_t handle = calloc(1, sizeof(mpu6050_i2c_linux_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	handle->fd = -1;
+	handle->xfer_max = MPU6050_I2C_LINUX_XFER_MAX;
+
+	return handle;
+}
+
+err_code_t mpu6050_i2c_linux_set_config(mpu6050_i2c_linux_handle_t handle, mpu6050_i2c_linux_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->dev_path = config.dev_path;
+	handle->ioctl = (config.ioctl != NULL) ? config.ioctl : mpu6050_i2c_linux_sys_ioctl;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_i2c_linux_config(mpu6050_i2c_linux_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* No device path, transfers go to the ioctl function with fd -1 */
+	if (handle->dev_path == NULL)
+	{
+		return ERR_CODE_SUCCESS;
+	}
+
+	if (handle->fd >= 0)
+	{
+		close(handle->fd);
+	}
+
+	handle->fd = open(handle->dev_path, O_RDWR);
+	if (handle->fd < 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_i2c_linux_deinit(mpu6050_i2c_linux_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->fd >= 0)
+	{
+		close(handle->fd);
+	}
+
+	free(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_i2c_linux_send(mpu6050_i2c_linux_handle_t handle, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf_send, uint16_t len)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || ((buf_send == NULL) && (len != 0)))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (len > MPU6050_I2C_LINUX_SEND_MAX)
+	{
+		return ERR_CODE_INVALID_ARG;
+	}
+
+	/* Register address and data go out in one write message */
+	uint8_t buffer[1 + MPU6050_I2C_LINUX_SEND_MAX];
+	buffer[0] = reg_addr;
+	if (len > 0)
+	{
+		memcpy(&buffer[1], buf_send, len);
+	}
+
+	struct i2c_msg msg = {
+		.addr = dev_addr,
+		.flags = 0,
+		.len = 1 + len,
+		.buf = buffer,
+	};
+	struct i2c_rdwr_ioctl_data data = {
+		.msgs = &msg,
+		.nmsgs = 1,
+	};
+
+	if (handle->ioctl(handle->fd, I2C_RDWR, &data) < 0)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_i2c_linux_recv(mpu6050_i2c_linux_handle_t handle, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf_recv, uint16_t len)
+{
+	mpu6050_i2c_linux_xfer_t xfer = {
+		.dev_addr = dev_addr,
+		.reg_addr = reg_addr,
+		.buf_recv = buf_recv,
+		.len = len,
+	};
+
+	return mpu6050_i2c_linux_recv_multi(handle, &xfer, 1);
+}
+
+err_code_t mpu6050_i2c_linux_recv_multi(mpu6050_i2c_linux_handle_t handle, const mpu6050_i2c_linux_xfer_t *xfer, uint32_t num_xfer)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (xfer == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	struct i2c_msg msgs[2 * MPU6050_I2C_LINUX_XFER_MAX];
+	uint8_t reg_addr[MPU6050_I2C_LINUX_XFER_MAX];
+
+	while (num_xfer > 0)
+	{
+		uint32_t num = (num_xfer > handle->xfer_max) ? handle->xfer_max : num_xfer;
+
+		/* Each read is a register address write followed by a repeated start read */
+		for (uint32_t i = 0; i < num; i++)
+		{
+			if (xfer[i].buf_recv == NULL)
+			{
+				return ERR_CODE_NULL_PTR;
+			}
+
+			reg_addr[i] = xfer[i].reg_addr;
+
+			msgs[2 * i].addr = xfer[i].dev_addr;
+			msgs[2 * i].flags = 0;
+			msgs[2 * i].len = 1;
+			msgs[2 * i].buf = &reg_addr[i];
+
+			msgs[2 * i + 1].addr = xfer[i].dev_addr;
+			msgs[2 * i + 1].flags = I2C_M_RD;
+			msgs[2 * i + 1].len = xfer[i].len;
+			msgs[2 * i + 1].buf = xfer[i].buf_recv;
+		}
+
+		struct i2c_rdwr_ioctl_data data = {
+			.msgs = msgs,
+			.nmsgs = 2 * num,
+		};
+
+		if (handle->ioctl(handle->fd, I2C_RDWR, &data) < 0)
+		{
+			/* Adapter limits messages per transfer, fall back to one read per ioctl */
+			if ((errno == EOPNOTSUPP) && (num > 1))
+			{
+				handle->xfer_max = 1;
+				continue;
+			}
+
+			return ERR_CODE_FAIL;
+		}
+
+		xfer += num;
+		num_xfer -= num;
+	}
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,177 @@
+// MIT License
+
+// Copyright (c) 2024 phonght32
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __MPU6050_I2C_LINUX_H__
+#define __MPU6050_I2C_LINUX_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+
+#define MPU6050_I2C_LINUX_SEND_MAX      32          /*!< Maximum number of bytes per send */
+
+typedef int (*mpu6050_i2c_linux_func_ioctl)(int fd, unsigned long request, void *arg);
+
+/**
+ * @brief   Handle structure.
+ */
+typedef struct mpu6050_i2c_linux *mpu6050_i2c_linux_handle_t;
+
+/**
+ * @brief   Configuration structure.
+ */
+typedef struct {
+	const char                      *dev_path;          /*!< I2C device path, e.g. "/dev/i2c-1". NULL to skip opening */
+	mpu6050_i2c_linux_func_ioctl    ioctl;              /*!< ioctl function. NULL to use the system ioctl */
+} mpu6050_i2c_linux_cfg_t;
+
+/**
+ * @brief   Register read transfer.
+ */
+typedef struct {
+	uint8_t                         dev_addr;           /*!< 7-bit device address */
+	uint8_t                         reg_addr;           /*!< Register address */
+	uint8_t                         *buf_recv;          /*!< Receive buffer */
+	uint16_t                        len;                /*!< Number of bytes to read */
+} mpu6050_i2c_linux_xfer_t;
+
+/*
+ * @brief   Define MPU6050 send and receive functions bound to one device.
+ *
+ * @note    Expands to name##_send and name##_recv, which can be used as
+ *          i2c_send and i2c_recv in mpu6050_cfg_t.
+ *
+ * @param   name Function name prefix.
+ * @param   i2c_handle Transport handle expression, evaluated on each call.
+ * @param   dev_addr 7-bit device address.
+ */
+#define MPU6050_I2C_LINUX_DEFINE_FUNC(name, i2c_handle, dev_addr)                                 \
+	static err_code_t name##_send(uint8_t reg_addr, uint8_t *buf_send, uint16_t len)              \
+	{                                                                                               \
+		return mpu6050_i2c_linux_send((i2c_handle), (dev_addr), reg_addr, buf_send, len);         \
+	}                                                                                               \
+	static err_code_t name##_recv(uint8_t reg_addr, uint8_t *buf_recv, uint16_t len)              \
+	{                                                                                               \
+		return mpu6050_i2c_linux_recv((i2c_handle), (dev_addr), reg_addr, buf_recv, len);         \
+	}
+
+/*
+ * @brief   Initialize Linux I2C transport.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - Others:           Fail.
+ */
+mpu6050_i2c_linux_handle_t mpu6050_i2c_linux_init(void);
+
+/*
+ * @brief   Set configuration parameters.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_i2c_linux_set_config(mpu6050_i2c_linux_handle_t handle, mpu6050_i2c_linux_cfg_t config);
+
+/*
+ * @brief   Open I2C device.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_i2c_linux_config(mpu6050_i2c_linux_handle_t handle);
+
+/*
+ * @brief   Close I2C device and free handle structure.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_i2c_linux_deinit(mpu6050_i2c_linux_handle_t handle);
+
+/*
+ * @brief   Write registers in one transfer.
+ *
+ * @param   handle Handle structure.
+ * @param   dev_addr 7-bit device address.
+ * @param   reg_addr Register address.
+ * @param   buf_send Data to write, at most MPU6050_I2C_LINUX_SEND_MAX bytes.
+ * @param   len Number of bytes to write.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_i2c_linux_send(mpu6050_i2c_linux_handle_t handle, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf_send, uint16_t len);
+
+/*
+ * @brief   Read registers with a repeated start transfer.
+ *
+ * @param   handle Handle structure.
+ * @param   dev_addr 7-bit device address.
+ * @param   reg_addr Register address.
+ * @param   buf_recv Receive buffer.
+ * @param   len Number of bytes to read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_i2c_linux_recv(mpu6050_i2c_linux_handle_t handle, uint8_t dev_addr, uint8_t reg_addr, uint8_t *buf_recv, uint16_t len);
+
+/*
+ * @brief   Read registers of several devices in combined transfers.
+ *
+ * @note    Reads are packed into as few I2C_RDWR ioctl calls as the kernel
+ *          message limit allows, 21 reads per call. If the adapter rejects
+ *          combined transfers with EOPNOTSUPP, the handle falls back to one
+ *          read per call from then on.
+ *
+ * @param   handle Handle structure.
+ * @param   xfer Read transfers.
+ * @param   num_xfer Number of read transfers.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_i2c_linux_recv_multi(mpu6050_i2c_linux_handle_t handle, const mpu6050_i2c_linux_xfer_t *xfer, uint32_t num_xfer);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MPU6050_I2C_LINUX_H__ */
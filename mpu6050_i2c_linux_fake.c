@@ -0,0 +1,105 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "errno.h"
+#include "linux/i2c.h"
+#include "linux/i2c-dev.h"
+#include "mpu6050_i2c_linux_fake.h"
+
+#define FAKE_DEV_ADDR_NUM           128         /*!< Number of 7-bit addresses */
+
+
+typedef struct {
+	uint8_t                     present;                    /*!< Device added */
+	uint8_t                     reg_ptr;                    /*!< Register pointer */
+	uint8_t                     regs[MPU6050_I2C_LINUX_FAKE_REG_NUM];  /*!< Register file */
+} mpu6050_i2c_linux_fake_dev_t;
+
+static mpu6050_i2c_linux_fake_dev_t fake_devs[FAKE_DEV_ADDR_NUM];
+static uint32_t fake_num_ioctl;
+static uint32_t fake_max_msgs;
+
+int mpu6050_i2c_linux_fake_ioctl(int fd, unsigned long request, void *arg)
+{
+	(void)fd;
+
+	if ((request != I2C_RDWR) || (arg == NULL))
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	struct i2c_rdwr_ioctl_data *data = arg;
+	if (data->nmsgs > I2C_RDWR_IOCTL_MAX_MSGS)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	fake_num_ioctl++;
+
+	if ((fake_max_msgs != 0) && (data->nmsgs > fake_max_msgs))
+	{
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < data->nmsgs; i++)
+	{
+		struct i2c_msg *msg = &data->msgs[i];
+		if ((msg->addr >= FAKE_DEV_ADDR_NUM) || !fake_devs[msg->addr].present)
+		{
+			errno = ENXIO;
+			return -1;
+		}
+
+		mpu6050_i2c_linux_fake_dev_t *dev = &fake_devs[msg->addr];
+		for (uint16_t n = 0; n < msg->len; n++)
+		{
+			if (msg->flags & I2C_M_RD)
+			{
+				msg->buf[n] = dev->regs[dev->reg_ptr++];
+			}
+			else if (n == 0)
+			{
+				dev->reg_ptr = msg->buf[0];
+			}
+			else
+			{
+				dev->regs[dev->reg_ptr++] = msg->buf[n];
+			}
+		}
+	}
+
+	return data->nmsgs;
+}
+
+void mpu6050_i2c_linux_fake_reset(void)
+{
+	memset(fake_devs, 0, sizeof(fake_devs));
+	fake_num_ioctl = 0;
+	fake_max_msgs = 0;
+}
+
+uint8_t *mpu6050_i2c_linux_fake_add_device(uint8_t dev_addr)
+{
+	if (dev_addr >= FAKE_DEV_ADDR_NUM)
+	{
+		return NULL;
+	}
+
+	memset(&fake_devs[dev_addr], 0, sizeof(mpu6050_i2c_linux_fake_dev_t));
+	fake_devs[dev_addr].present = 1;
+
+	return fake_devs[dev_addr].regs;
+}
+
+uint32_t mpu6050_i2c_linux_fake_get_num_ioctl(void)
+{
+	return fake_num_ioctl;
+}
+
+void mpu6050_i2c_linux_fake_set_max_msgs(uint32_t max_msgs)
+{
+	fake_max_msgs = max_msgs;
+}
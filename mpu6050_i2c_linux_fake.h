@@ -0,0 +1,93 @@
+// MIT License
+
+// Copyright (c) 2024 phonght32
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __MPU6050_I2C_LINUX_FAKE_H__
+#define __MPU6050_I2C_LINUX_FAKE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+
+#define MPU6050_I2C_LINUX_FAKE_REG_NUM  256         /*!< Registers per simulated device */
+
+/*
+ * @brief   Simulated I2C_RDWR ioctl over per-device register files.
+ *
+ * @note    Pass as ioctl in mpu6050_i2c_linux_cfg_t with dev_path NULL.
+ *          A write message sets the register pointer from its first byte
+ *          and stores the rest, a read message returns registers from the
+ *          pointer. The pointer auto increments. Transfers to a device not
+ *          added fail with ENXIO, like a NACK. Not thread safe.
+ */
+int mpu6050_i2c_linux_fake_ioctl(int fd, unsigned long request, void *arg);
+
+/*
+ * @brief   Remove all simulated devices, clear ioctl counter and message
+ *          limit.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+void mpu6050_i2c_linux_fake_reset(void);
+
+/*
+ * @brief   Add a simulated device with all registers 0.
+ *
+ * @param   dev_addr 7-bit device address.
+ *
+ * @return
+ *      - Register file of MPU6050_I2C_LINUX_FAKE_REG_NUM bytes: Success.
+ *      - NULL:           Fail.
+ */
+uint8_t *mpu6050_i2c_linux_fake_add_device(uint8_t dev_addr);
+
+/*
+ * @brief   Get number of ioctl calls since last reset.
+ *
+ * @param   None.
+ *
+ * @return  Number of ioctl calls.
+ */
+uint32_t mpu6050_i2c_linux_fake_get_num_ioctl(void);
+
+/*
+ * @brief   Limit messages per ioctl like an adapter quirk.
+ *
+ * @note    Transfers with more messages fail with EOPNOTSUPP and still
+ *          count as an ioctl call.
+ *
+ * @param   max_msgs Maximum number of messages per ioctl. 0 for no limit.
+ *
+ * @return  None.
+ */
+void mpu6050_i2c_linux_fake_set_max_msgs(uint32_t max_msgs);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MPU6050_I2C_LINUX_FAKE_H__ */
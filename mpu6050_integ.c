@@ -0,0 +1,310 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "mpu6050_integ.h"
+
+#define INTEG_CHUNK_SIZE            32          /*!< Samples per vectorized step */
+#define INTEG_DEG_TO_RAD            (3.14159265358979f / 180.0f)
+
+
+typedef struct mpu6050_integ {
+	uint32_t                    interval_us;                /*!< Increment interval (us) */
+	float                       gravity;                    /*!< Gravity (m/s^2) */
+	uint8_t                     has_prev;                   /*!< Previous sample is valid */
+	uint64_t                    t_prev;                     /*!< Previous sample timestamp */
+	float                       gyro_prev[3];               /*!< Previous angular rate (rad/s) */
+	float                       accel_prev[3];              /*!< Previous specific force (m/s^2) */
+	uint64_t                    t_start;                    /*!< Current interval start */
+	uint32_t                    num_sample;                 /*!< Samples in current interval */
+	float                       alpha[3];                   /*!< Summed delta angle */
+	float                       nu[3];                      /*!< Summed delta velocity */
+	float                       coning[3];                  /*!< Coning correction */
+	float                       sculling[3];                /*!< Sculling correction */
+	float                       dalpha_prev[3];             /*!< Previous step delta angle */
+	float                       dnu_prev[3];                /*!< Previous step delta velocity */
+	mpu6050_integ_delta_t       *buf;                       /*!< Increment ring buffer */
+	uint16_t                    buf_size;                   /*!< Ring buffer size */
+	uint16_t                    head;                       /*!< Ring buffer write index */
+	uint16_t                    count;                      /*!< Ring buffer number of increments */
+} mpu6050_integ_t;
+
+static void mpu6050_integ_cross(const float a[3], const float b[3], float out[3])
+{
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void mpu6050_integ_clear(mpu6050_integ_handle_t handle)
+{
+	handle->num_sample = 0;
+	memset(handle->alpha, 0, sizeof(handle->alpha));
+	memset(handle->nu, 0, sizeof(handle->nu));
+	memset(handle->coning, 0, sizeof(handle->coning));
+	memset(handle->sculling, 0, sizeof(handle->sculling));
+}
+
+static void mpu6050_integ_emit(mpu6050_integ_handle_t handle, uint64_t t_end)
+{
+	mpu6050_integ_delta_t *delta = &handle->buf[handle->head];
+
+	/* Rotation compensation of the summed velocity, plus coning and sculling */
+	float rot[3];
+	mpu6050_integ_cross(handle->alpha, handle->nu, rot);
+
+	for (int i = 0; i < 3; i++)
+	{
+		delta->delta_angle[i] = handle->alpha[i] + handle->coning[i];
+		delta->delta_velocity[i] = handle->nu[i] + 0.5f * rot[i] + handle->sculling[i];
+	}
+	delta->t_start_us = handle->t_start;
+	delta->t_end_us = t_end;
+	delta->num_sample = handle->num_sample;
+
+	handle->head = (handle->head + 1) % handle->buf_size;
+	if (handle->count < handle->buf_size)
+	{
+		handle->count++;
+	}
+
+	mpu6050_integ_clear(handle);
+	handle->t_start = t_end;
+}
+
+mpu6050_integ_handle_t mpu6050_integ_init(void)
+{
+	mpu6050_integ_handle_t handle = calloc(1, sizeof(mpu6050_integ_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t mpu6050_integ_deinit(mpu6050_integ_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	free(handle->buf);
+	free(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_integ_set_config(mpu6050_integ_handle_t handle, mpu6050_integ_cfg_t config)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.interval_us == 0) || (config.buf_size == 0))
+	{
+		return ERR_CODE_INVALID_ARG;
+	}
+
+	mpu6050_integ_delta_t *buf = calloc(config.buf_size, sizeof(mpu6050_integ_delta_t));
+	if (buf == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	free(handle->buf);
+	handle->buf = buf;
+	handle->buf_size = config.buf_size;
+	handle->head = 0;
+	handle->count = 0;
+	handle->interval_us = config.interval_us;
+	handle->gravity = (config.gravity > 0.0f) ? config.gravity : MPU6050_INTEG_GRAVITY_DEFAULT;
+
+	return mpu6050_integ_reset(handle);
+}
+
+err_code_t mpu6050_integ_reset(mpu6050_integ_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	handle->has_prev = 0;
+	memset(handle->dalpha_prev, 0, sizeof(handle->dalpha_prev));
+	memset(handle->dnu_prev, 0, sizeof(handle->dnu_prev));
+	mpu6050_integ_clear(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_integ_update(mpu6050_integ_handle_t handle, const mpu6050_scale_sample_t *samples, const uint64_t *timestamp_us, uint32_t num_sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL) || (timestamp_us == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->buf == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	const float gyro_factor = INTEG_DEG_TO_RAD;
+	const float accel_factor = handle->gravity;
+
+	/* Rates in SI unit of each sample, then per step increments */
+	float w[3][INTEG_CHUNK_SIZE + 1], f[3][INTEG_CHUNK_SIZE + 1];
+	float dalpha[3][INTEG_CHUNK_SIZE], dnu[3][INTEG_CHUNK_SIZE];
+	float dt[INTEG_CHUNK_SIZE];
+	uint64_t t[INTEG_CHUNK_SIZE + 1];
+
+	uint32_t n = 0;
+	while (n < num_sample)
+	{
+		/* First sample ever only provides the starting point */
+		if (!handle->has_prev)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				handle->gyro_prev[i] = samples[n].gyro[i] * gyro_factor;
+				handle->accel_prev[i] = samples[n].accel[i] * accel_factor;
+			}
+			handle->t_prev = timestamp_us[n];
+			handle->t_start = timestamp_us[n];
+			handle->has_prev = 1;
+			n++;
+			continue;
+		}
+
+		/* Gather a chunk of samples with advancing timestamps; slot 0 is the previous sample */
+		uint32_t len = 0;
+		uint8_t restart = 0;
+		t[0] = handle->t_prev;
+		for (int i = 0; i < 3; i++)
+		{
+			w[i][0] = handle->gyro_prev[i];
+			f[i][0] = handle->accel_prev[i];
+		}
+		while ((n < num_sample) && (len < INTEG_CHUNK_SIZE))
+		{
+			/* Time went backwards, the timestamp source restarted */
+			if (timestamp_us[n] < t[len])
+			{
+				restart = 1;
+				break;
+			}
+
+			if (timestamp_us[n] > t[len])
+			{
+				len++;
+				t[len] = timestamp_us[n];
+				for (int i = 0; i < 3; i++)
+				{
+					w[i][len] = samples[n].gyro[i] * gyro_factor;
+					f[i][len] = samples[n].accel[i] * accel_factor;
+				}
+			}
+			n++;
+		}
+
+		/* Trapezoidal increments, independent per step */
+		for (uint32_t k = 0; k < len; k++)
+		{
+			dt[k] = (float)(t[k + 1] - t[k]) * 1e-6f;
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			for (uint32_t k = 0; k < len; k++)
+			{
+				dalpha[i][k] = 0.5f * (w[i][k] + w[i][k + 1]) * dt[k];
+				dnu[i][k] = 0.5f * (f[i][k] + f[i][k + 1]) * dt[k];
+			}
+		}
+
+		/* Coning and sculling recursion, sequential by nature */
+		for (uint32_t k = 0; k < len; k++)
+		{
+			float da[3] = {dalpha[0][k], dalpha[1][k], dalpha[2][k]};
+			float dv[3] = {dnu[0][k], dnu[1][k], dnu[2][k]};
+			float a[3], v[3], c[3];
+
+			for (int i = 0; i < 3; i++)
+			{
+				a[i] = handle->alpha[i] + handle->dalpha_prev[i] / 6.0f;
+				v[i] = handle->nu[i] + handle->dnu_prev[i] / 6.0f;
+			}
+
+			mpu6050_integ_cross(a, da, c);
+			for (int i = 0; i < 3; i++)
+			{
+				handle->coning[i] += 0.5f * c[i];
+			}
+
+			float s1[3], s2[3];
+			mpu6050_integ_cross(a, dv, s1);
+			mpu6050_integ_cross(v, da, s2);
+			for (int i = 0; i < 3; i++)
+			{
+				handle->sculling[i] += 0.5f * (s1[i] + s2[i]);
+				handle->alpha[i] += da[i];
+				handle->nu[i] += dv[i];
+				handle->dalpha_prev[i] = da[i];
+				handle->dnu_prev[i] = dv[i];
+			}
+			handle->num_sample++;
+
+			if (t[k + 1] - handle->t_start >= handle->interval_us)
+			{
+				mpu6050_integ_emit(handle, t[k + 1]);
+			}
+		}
+
+		handle->t_prev = t[len];
+		for (int i = 0; i < 3; i++)
+		{
+			handle->gyro_prev[i] = w[i][len];
+			handle->accel_prev[i] = f[i][len];
+		}
+
+		/* Drop the open interval, the sample at n starts a new one */
+		if (restart)
+		{
+			mpu6050_integ_reset(handle);
+		}
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_integ_read(mpu6050_integ_handle_t handle, mpu6050_integ_delta_t *deltas, uint16_t max_delta, uint16_t *num_delta)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (deltas == NULL) || (num_delta == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (handle->buf == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	uint16_t num = (handle->count < max_delta) ? handle->count : max_delta;
+	uint16_t tail = (handle->head + handle->buf_size - handle->count) % handle->buf_size;
+
+	for (uint16_t i = 0; i < num; i++)
+	{
+		deltas[i] = handle->buf[(tail + i) % handle->buf_size];
+	}
+
+	handle->count -= num;
+	*num_delta = num;
+
+	return ERR_CODE_SUCCESS;
+}
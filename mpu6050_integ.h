@@ -0,0 +1,152 @@
+// MIT License
+
+// Copyright (c) 2024 phonght32
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __MPU6050_INTEG_H__
+#define __MPU6050_INTEG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "mpu6050.h"
+
+#define MPU6050_INTEG_GRAVITY_DEFAULT   9.80665f    /*!< Standard gravity (m/s^2) */
+
+/**
+ * @brief   Handle structure.
+ */
+typedef struct mpu6050_integ *mpu6050_integ_handle_t;
+
+/**
+ * @brief   Configuration structure.
+ */
+typedef struct {
+	uint32_t                    interval_us;                /*!< Increment interval (us) */
+	float                       gravity;                    /*!< Gravity used to convert g to m/s^2, 0 for default */
+	uint16_t                    buf_size;                   /*!< Increment ring buffer size */
+} mpu6050_integ_cfg_t;
+
+/**
+ * @brief   Delta angle and delta velocity increment.
+ *
+ * @note    Increments are coning and sculling compensated and expressed in
+ *          the sensor frame at t_start_us.
+ */
+typedef struct {
+	uint64_t                    t_start_us;                 /*!< Interval start timestamp (us) */
+	uint64_t                    t_end_us;                   /*!< Interval end timestamp (us) */
+	float                       delta_angle[3];             /*!< Delta angle x, y, z axis (rad) */
+	float                       delta_velocity[3];          /*!< Delta velocity x, y, z axis (m/s) */
+	uint32_t                    num_sample;                 /*!< Number of samples integrated */
+} mpu6050_integ_delta_t;
+
+/*
+ * @brief   Initialize integration stage.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - Others:           Fail.
+ */
+mpu6050_integ_handle_t mpu6050_integ_init(void);
+
+/*
+ * @brief   Free integration stage.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_integ_deinit(mpu6050_integ_handle_t handle);
+
+/*
+ * @brief   Set configuration parameters.
+ *
+ * @note    Resets integration state and drops buffered increments.
+ *
+ * @param   handle Handle structure.
+ * @param   config Configuration structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_integ_set_config(mpu6050_integ_handle_t handle, mpu6050_integ_cfg_t config);
+
+/*
+ * @brief   Reset integration state. The next sample starts a new interval.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_integ_reset(mpu6050_integ_handle_t handle);
+
+/*
+ * @brief   Integrate a batch of timestamped samples.
+ *
+ * @note    Each step uses the real time between samples, so sampling jitter
+ *          does not turn into drift. A sample with the same timestamp as
+ *          the previous one is ignored. A timestamp going backwards means
+ *          the time source restarted: the open interval is dropped and a
+ *          new one starts at that sample. An interval closes on the first
+ *          sample at or past interval_us from its start. When the ring
+ *          buffer is full the oldest increment is dropped.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Scaled samples, accelerometer in g, gyroscope in deg/s.
+ * @param   timestamp_us Timestamp of each sample (us).
+ * @param   num_sample Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_integ_update(mpu6050_integ_handle_t handle, const mpu6050_scale_sample_t *samples, const uint64_t *timestamp_us, uint32_t num_sample);
+
+/*
+ * @brief   Read completed increments.
+ *
+ * @param   handle Handle structure.
+ * @param   deltas Increments.
+ * @param   max_delta Maximum number of increments to read.
+ * @param   num_delta Number of increments read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_integ_read(mpu6050_integ_handle_t handle, mpu6050_integ_delta_t *deltas, uint16_t max_delta, uint16_t *num_delta);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MPU6050_INTEG_H__ */
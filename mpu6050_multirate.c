@@ -0,0 +1,223 @@
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "mpu6050_multirate.h"
+
+#define MULTIRATE_AXIS_NUM          6           /*!< Accelerometer and gyroscope axes */
+#define MULTIRATE_GAIN_MAX          (1ULL << 47)/*!< Maximum CIC gain, keeps 16 bit data inside 64 bit registers */
+
+
+typedef struct {
+	uint16_t                    decim;                      /*!< Decimation ratio */
+	uint8_t                     order;                      /*!< CIC filter order */
+	uint16_t                    phase;                      /*!< Input samples since last output */
+	int64_t                     gain;                       /*!< CIC gain, decim^order */
+	uint64_t                    integ[MPU6050_MULTIRATE_ORDER_MAX][MULTIRATE_AXIS_NUM];    /*!< Integrator states */
+	uint64_t                    comb[MPU6050_MULTIRATE_ORDER_MAX][MULTIRATE_AXIS_NUM];     /*!< Comb delay states */
+	mpu6050_raw_sample_t        *buf;                       /*!< Ring buffer */
+	uint16_t                    buf_size;                   /*!< Ring buffer size */
+	uint16_t                    head;                       /*!< Ring buffer write index */
+	uint16_t                    count;                      /*!< Ring buffer number of samples */
+} mpu6050_multirate_output_t;
+
+typedef struct mpu6050_multirate {
+	mpu6050_multirate_output_t  *outputs;                   /*!< Decimated outputs */
+	uint8_t                     num_output;                 /*!< Number of outputs */
+} mpu6050_multirate_t;
+
+static void mpu6050_multirate_push(mpu6050_multirate_output_t *output, const int64_t value[MULTIRATE_AXIS_NUM])
+{
+	mpu6050_raw_sample_t *sample = &output->buf[output->head];
+
+	for (int a = 0; a < 3; a++)
+	{
+		sample->accel[a] = (int16_t)value[a];
+		sample->gyro[a] = (int16_t)value[3 + a];
+	}
+
+	output->head = (output->head + 1) % output->buf_size;
+	if (output->count < output->buf_size)
+	{
+		output->count++;
+	}
+}
+
+static void mpu6050_multirate_filter(mpu6050_multirate_output_t *output, const mpu6050_raw_sample_t *samples, uint32_t num_sample)
+{
+	/* Registers wrap modulo 2^64, which is exact for CIC as long as the
+	 * output range fits, so plain unsigned arithmetic is used.
+	 */
+	for (uint32_t n = 0; n < num_sample; n++)
+	{
+		uint64_t x[MULTIRATE_AXIS_NUM];
+		for (int a = 0; a < 3; a++)
+		{
+			x[a] = (uint64_t)(int64_t)samples[n].accel[a];
+			x[3 + a] = (uint64_t)(int64_t)samples[n].gyro[a];
+		}
+
+		/* Integrator stages at input rate */
+		for (int s = 0; s < output->order; s++)
+		{
+			for (int a = 0; a < MULTIRATE_AXIS_NUM; a++)
+			{
+				output->integ[s][a] += x[a];
+				x[a] = output->integ[s][a];
+			}
+		}
+
+		if (++output->phase < output->decim)
+		{
+			continue;
+		}
+		output->phase = 0;
+
+		/* Comb stages at output rate */
+		for (int s = 0; s < output->order; s++)
+		{
+			for (int a = 0; a < MULTIRATE_AXIS_NUM; a++)
+			{
+				uint64_t y = x[a] - output->comb[s][a];
+				output->comb[s][a] = x[a];
+				x[a] = y;
+			}
+		}
+
+		/* Remove CIC gain with rounding */
+		int64_t value[MULTIRATE_AXIS_NUM];
+		for (int a = 0; a < MULTIRATE_AXIS_NUM; a++)
+		{
+			int64_t y = (int64_t)x[a];
+			value[a] = (y >= 0) ? (y + output->gain / 2) / output->gain : (y - output->gain / 2) / output->gain;
+		}
+
+		mpu6050_multirate_push(output, value);
+	}
+}
+
+mpu6050_multirate_handle_t mpu6050_multirate_init(void)
+{
+	mpu6050_multirate_handle_t handle = calloc(1, sizeof(mpu6050_multirate_t));
+	if (handle == NULL)
+	{
+		return NULL;
+	}
+
+	return handle;
+}
+
+err_code_t mpu6050_multirate_deinit(mpu6050_multirate_handle_t handle)
+{
+	/* Check if handle structure is NULL */
+	if (handle == NULL)
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	for (uint8_t i = 0; i < handle->num_output; i++)
+	{
+		free(handle->outputs[i].buf);
+	}
+	free(handle->outputs);
+	free(handle);
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_multirate_add_output(mpu6050_multirate_handle_t handle, mpu6050_multirate_output_cfg_t config, uint8_t *output_id)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (output_id == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if ((config.decim == 0) || (config.order == 0) || (config.order > MPU6050_MULTIRATE_ORDER_MAX) ||
+	    (config.buf_size == 0) || (handle->num_output == UINT8_MAX))
+	{
+		return ERR_CODE_INVALID_ARG;
+	}
+
+	uint64_t gain = 1;
+	for (uint8_t s = 0; s < config.order; s++)
+	{
+		gain *= config.decim;
+	}
+	if (gain > MULTIRATE_GAIN_MAX)
+	{
+		return ERR_CODE_INVALID_ARG;
+	}
+
+	mpu6050_raw_sample_t *buf = calloc(config.buf_size, sizeof(mpu6050_raw_sample_t));
+	if (buf == NULL)
+	{
+		return ERR_CODE_FAIL;
+	}
+
+	mpu6050_multirate_output_t *outputs = realloc(handle->outputs, (handle->num_output + 1) * sizeof(mpu6050_multirate_output_t));
+	if (outputs == NULL)
+	{
+		free(buf);
+		return ERR_CODE_FAIL;
+	}
+	handle->outputs = outputs;
+
+	mpu6050_multirate_output_t *output = &handle->outputs[handle->num_output];
+	memset(output, 0, sizeof(mpu6050_multirate_output_t));
+	output->decim = config.decim;
+	output->order = config.order;
+	output->gain = (int64_t)gain;
+	output->buf = buf;
+	output->buf_size = config.buf_size;
+
+	*output_id = handle->num_output;
+	handle->num_output++;
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_multirate_update(mpu6050_multirate_handle_t handle, const mpu6050_raw_sample_t *samples, uint32_t num_sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	/* Run each output over the whole batch so its state stays in cache */
+	for (uint8_t i = 0; i < handle->num_output; i++)
+	{
+		mpu6050_multirate_filter(&handle->outputs[i], samples, num_sample);
+	}
+
+	return ERR_CODE_SUCCESS;
+}
+
+err_code_t mpu6050_multirate_read(mpu6050_multirate_handle_t handle, uint8_t output_id, mpu6050_raw_sample_t *samples, uint16_t max_sample, uint16_t *num_sample)
+{
+	/* Check if handle structure or pointer data is NULL */
+	if ((handle == NULL) || (samples == NULL) || (num_sample == NULL))
+	{
+		return ERR_CODE_NULL_PTR;
+	}
+
+	if (output_id >= handle->num_output)
+	{
+		return ERR_CODE_INVALID_ARG;
+	}
+
+	mpu6050_multirate_output_t *output = &handle->outputs[output_id];
+
+	uint16_t num = (output->count < max_sample) ? output->count : max_sample;
+	uint16_t tail = (output->head + output->buf_size - output->count) % output->buf_size;
+
+	for (uint16_t i = 0; i < num; i++)
+	{
+		samples[i] = output->buf[(tail + i) % output->buf_size];
+	}
+
+	output->count -= num;
+	*num_sample = num;
+
+	return ERR_CODE_SUCCESS;
+}
@@ -0,0 +1,129 @@
+// MIT License
+
+// Copyright (c) 2024 phonght32
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __MPU6050_MULTIRATE_H__
+#define __MPU6050_MULTIRATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "err_code.h"
+#include "mpu6050.h"
+
+#define MPU6050_MULTIRATE_ORDER_MAX     4           /*!< Maximum CIC filter order */
+
+/**
+ * @brief   Handle structure.
+ */
+typedef struct mpu6050_multirate *mpu6050_multirate_handle_t;
+
+/**
+ * @brief   Decimated output configuration structure.
+ *
+ * @note    Output rate is the input rate divided by decim, where the input
+ *          rate is the sample rate set by mpu6050_set_sample_rate_div.
+ *          The CIC gain decim^order must not exceed 2^47.
+ */
+typedef struct {
+	uint16_t                    decim;                      /*!< Decimation ratio */
+	uint8_t                     order;                      /*!< CIC filter order, 1 to MPU6050_MULTIRATE_ORDER_MAX */
+	uint16_t                    buf_size;                   /*!< Ring buffer size in samples */
+} mpu6050_multirate_output_cfg_t;
+
+/*
+ * @brief   Initialize multi-rate stage.
+ *
+ * @param   None.
+ *
+ * @return
+ *      - Handle structure: Success.
+ *      - Others:           Fail.
+ */
+mpu6050_multirate_handle_t mpu6050_multirate_init(void);
+
+/*
+ * @brief   Free multi-rate stage and all outputs.
+ *
+ * @param   handle Handle structure.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_multirate_deinit(mpu6050_multirate_handle_t handle);
+
+/*
+ * @brief   Add a decimated output.
+ *
+ * @param   handle Handle structure.
+ * @param   config Output configuration structure.
+ * @param   output_id Output index, used to read the output.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_multirate_add_output(mpu6050_multirate_handle_t handle, mpu6050_multirate_output_cfg_t config, uint8_t *output_id);
+
+/*
+ * @brief   Feed full rate raw samples to all outputs.
+ *
+ * @note    Samples typically come from mpu6050_read_fifo or
+ *          mpu6050_get_raw_sample. When an output ring buffer is full the
+ *          oldest sample is dropped.
+ *
+ * @param   handle Handle structure.
+ * @param   samples Raw samples.
+ * @param   num_sample Number of samples.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_multirate_update(mpu6050_multirate_handle_t handle, const mpu6050_raw_sample_t *samples, uint32_t num_sample);
+
+/*
+ * @brief   Read decimated samples from an output ring buffer.
+ *
+ * @note    Samples keep the raw unit and can be converted with
+ *          mpu6050_convert_batch.
+ *
+ * @param   handle Handle structure.
+ * @param   output_id Output index.
+ * @param   samples Decimated raw samples.
+ * @param   max_sample Maximum number of samples to read.
+ * @param   num_sample Number of samples read.
+ *
+ * @return
+ *      - ERR_CODE_SUCCESS: Success.
+ *      - Others:           Fail.
+ */
+err_code_t mpu6050_multirate_read(mpu6050_multirate_handle_t handle, uint8_t output_id, mpu6050_raw_sample_t *samples, uint16_t max_sample, uint16_t *num_sample);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MPU6050_MULTIRATE_H__ */
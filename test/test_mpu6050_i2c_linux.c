@@ -0,0 +1,208 @@
+#include "stdio.h"
+#include "string.h"
+#include "mpu6050.h"
+#include "mpu6050_i2c_linux.h"
+#include "mpu6050_i2c_linux_fake.h"
+
+#define CHECK(cond)                                                             \
+	do {                                                                        \
+		if (!(cond))                                                            \
+		{                                                                       \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+			return 1;                                                           \
+		}                                                                       \
+	} while (0)
+
+#define DEV_ADDR_0                  0x68
+#define DEV_ADDR_1                  0x69
+#define DEV_ADDR_ABSENT             0x50
+#define NUM_XFER                    50          /*!< More than the 21 reads that fit in one ioctl */
+
+static mpu6050_i2c_linux_handle_t bus;
+
+MPU6050_I2C_LINUX_DEFINE_FUNC(imu0, bus, DEV_ADDR_0)
+
+static void test_delay(uint32_t time_ms)
+{
+	(void)time_ms;
+}
+
+static mpu6050_i2c_linux_handle_t test_bus_init(void)
+{
+	mpu6050_i2c_linux_fake_reset();
+
+	mpu6050_i2c_linux_handle_t handle = mpu6050_i2c_linux_init();
+	mpu6050_i2c_linux_cfg_t cfg = {
+		.dev_path = NULL,
+		.ioctl = mpu6050_i2c_linux_fake_ioctl,
+	};
+	mpu6050_i2c_linux_set_config(handle, cfg);
+	mpu6050_i2c_linux_config(handle);
+
+	return handle;
+}
+
+static void test_fill_xfer(mpu6050_i2c_linux_xfer_t *xfer, uint8_t buf[][MPU6050_BURST_SIZE], uint32_t num_xfer)
+{
+	for (uint32_t i = 0; i < num_xfer; i++)
+	{
+		xfer[i].dev_addr = (i % 2 == 0) ? DEV_ADDR_0 : DEV_ADDR_1;
+		xfer[i].reg_addr = MPU6050_BURST_REG;
+		xfer[i].buf_recv = buf[i];
+		xfer[i].len = MPU6050_BURST_SIZE;
+	}
+}
+
+static int test_single(void)
+{
+	bus = test_bus_init();
+	uint8_t *regs = mpu6050_i2c_linux_fake_add_device(DEV_ADDR_0);
+	regs[MPU6050_BURST_REG] = 0x12;
+	regs[MPU6050_BURST_REG + 1] = 0x34;
+
+	uint8_t buf[2] = {0};
+	CHECK(mpu6050_i2c_linux_recv(bus, DEV_ADDR_0, MPU6050_BURST_REG, buf, 2) == ERR_CODE_SUCCESS);
+	CHECK((buf[0] == 0x12) && (buf[1] == 0x34));
+
+	uint8_t data = 0x5A;
+	CHECK(mpu6050_i2c_linux_send(bus, DEV_ADDR_0, 0x1B, &data, 1) == ERR_CODE_SUCCESS);
+	CHECK(regs[0x1B] == 0x5A);
+	CHECK(mpu6050_i2c_linux_send(bus, DEV_ADDR_0, 0x1C, NULL, 0) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_i2c_linux_fake_get_num_ioctl() == 3);
+
+	/* Driver on top of the transport */
+	mpu6050_handle_t imu = mpu6050_init();
+	mpu6050_cfg_t cfg = {0};
+	cfg.gfs_sel = MPU6050_GFS_SEL_500;
+	cfg.i2c_send = imu0_send;
+	cfg.i2c_recv = imu0_recv;
+	cfg.delay = test_delay;
+	CHECK(mpu6050_set_config(imu, cfg) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_config(imu) == ERR_CODE_SUCCESS);
+	CHECK(regs[0x1B] == (MPU6050_GFS_SEL_500 << 3));
+	CHECK(regs[0x19] == 4);
+
+	CHECK(mpu6050_set_sample_rate_div(imu, 0) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_config(imu) == ERR_CODE_SUCCESS);
+	CHECK(regs[0x19] == 0);
+
+	int16_t accel_x, accel_y, accel_z;
+	CHECK(mpu6050_get_accel_raw(imu, &accel_x, &accel_y, &accel_z) == ERR_CODE_SUCCESS);
+	CHECK(accel_x == 0x1234);
+
+	mpu6050_i2c_linux_deinit(bus);
+	return 0;
+}
+
+static int test_multi_device(void)
+{
+	bus = test_bus_init();
+	uint8_t *regs[2] = {
+		mpu6050_i2c_linux_fake_add_device(DEV_ADDR_0),
+		mpu6050_i2c_linux_fake_add_device(DEV_ADDR_1),
+	};
+	for (int d = 0; d < 2; d++)
+	{
+		for (int i = 0; i < MPU6050_BURST_SIZE; i++)
+		{
+			regs[d][MPU6050_BURST_REG + i] = (uint8_t)(d * 0x80 + i);
+		}
+	}
+
+	uint8_t buf[NUM_XFER][MPU6050_BURST_SIZE];
+	mpu6050_i2c_linux_xfer_t xfer[NUM_XFER];
+	test_fill_xfer(xfer, buf, 2);
+
+	CHECK(mpu6050_i2c_linux_recv_multi(bus, xfer, 2) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_i2c_linux_fake_get_num_ioctl() == 1);
+	for (int d = 0; d < 2; d++)
+	{
+		for (int i = 0; i < MPU6050_BURST_SIZE; i++)
+		{
+			CHECK(buf[d][i] == (uint8_t)(d * 0x80 + i));
+		}
+	}
+
+	mpu6050_i2c_linux_deinit(bus);
+	return 0;
+}
+
+static int test_num_ioctl(void)
+{
+	bus = test_bus_init();
+	mpu6050_i2c_linux_fake_add_device(DEV_ADDR_0)[MPU6050_BURST_REG] = 0x11;
+	mpu6050_i2c_linux_fake_add_device(DEV_ADDR_1)[MPU6050_BURST_REG] = 0x22;
+
+	uint8_t buf[NUM_XFER][MPU6050_BURST_SIZE];
+	mpu6050_i2c_linux_xfer_t xfer[NUM_XFER];
+	test_fill_xfer(xfer, buf, NUM_XFER);
+
+	/* 50 reads of 2 messages each with at most 42 messages per ioctl */
+	CHECK(mpu6050_i2c_linux_recv_multi(bus, xfer, NUM_XFER) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_i2c_linux_fake_get_num_ioctl() == 3);
+	CHECK((buf[NUM_XFER - 2][0] == 0x11) && (buf[NUM_XFER - 1][0] == 0x22));
+
+	mpu6050_i2c_linux_deinit(bus);
+	return 0;
+}
+
+static int test_max_msgs_fallback(void)
+{
+	bus = test_bus_init();
+	mpu6050_i2c_linux_fake_add_device(DEV_ADDR_0)[MPU6050_BURST_REG] = 0x11;
+	mpu6050_i2c_linux_fake_add_device(DEV_ADDR_1)[MPU6050_BURST_REG] = 0x22;
+	mpu6050_i2c_linux_fake_set_max_msgs(2);
+
+	uint8_t buf[NUM_XFER][MPU6050_BURST_SIZE];
+	mpu6050_i2c_linux_xfer_t xfer[NUM_XFER];
+	test_fill_xfer(xfer, buf, NUM_XFER);
+
+	/* One rejected combined transfer, then one read per ioctl */
+	CHECK(mpu6050_i2c_linux_recv_multi(bus, xfer, NUM_XFER) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_i2c_linux_fake_get_num_ioctl() == 1 + NUM_XFER);
+	CHECK((buf[NUM_XFER - 2][0] == 0x11) && (buf[NUM_XFER - 1][0] == 0x22));
+
+	/* Fallback is kept for later calls */
+	CHECK(mpu6050_i2c_linux_recv_multi(bus, xfer, 2) == ERR_CODE_SUCCESS);
+	CHECK(mpu6050_i2c_linux_fake_get_num_ioctl() == 1 + NUM_XFER + 2);
+
+	mpu6050_i2c_linux_deinit(bus);
+	return 0;
+}
+
+static int test_absent_device(void)
+{
+	bus = test_bus_init();
+	mpu6050_i2c_linux_fake_add_device(DEV_ADDR_0);
+
+	uint8_t buf[2];
+	CHECK(mpu6050_i2c_linux_recv(bus, DEV_ADDR_ABSENT, MPU6050_BURST_REG, buf, 2) == ERR_CODE_FAIL);
+
+	uint8_t data = 0;
+	CHECK(mpu6050_i2c_linux_send(bus, DEV_ADDR_ABSENT, 0x1B, &data, 1) == ERR_CODE_FAIL);
+
+	/* NACK in the middle of a combined transfer fails the whole call */
+	mpu6050_i2c_linux_xfer_t xfer[2] = {
+		{.dev_addr = DEV_ADDR_0, .reg_addr = MPU6050_BURST_REG, .buf_recv = buf, .len = 1},
+		{.dev_addr = DEV_ADDR_ABSENT, .reg_addr = MPU6050_BURST_REG, .buf_recv = &buf[1], .len = 1},
+	};
+	CHECK(mpu6050_i2c_linux_recv_multi(bus, xfer, 2) == ERR_CODE_FAIL);
+
+	mpu6050_i2c_linux_deinit(bus);
+	return 0;
+}
+
+int main(void)
+{
+	int ret = 0;
+
+	ret |= test_single();
+	ret |= test_multi_device();
+	ret |= test_num_ioctl();
+	ret |= test_max_msgs_fallback();
+	ret |= test_absent_device();
+
+	printf("test_mpu6050_i2c_linux: %s\n", (ret == 0) ? "PASS" : "FAIL");
+
+	return ret;
+}
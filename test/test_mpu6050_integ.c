@@ -0,0 +1,196 @@
+#include "stdio.h"
+#include "math.h"
+#include "mpu6050.h"
+#include "mpu6050_integ.h"
+
+#define CHECK(cond)                                                             \
+	do {                                                                        \
+		if (!(cond))                                                            \
+		{                                                                       \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+			return 1;                                                           \
+		}                                                                       \
+	} while (0)
+
+#define CHECK_NEAR(a, b, tol)       CHECK(fabs((double)(a) - (double)(b)) <= (tol))
+
+#define NUM_SAMPLE                  101
+#define SAMPLE_PERIOD_US            1000
+#define INTERVAL_US                 10000
+#define NUM_DELTA                   ((NUM_SAMPLE - 1) * SAMPLE_PERIOD_US / INTERVAL_US)
+#define GRAVITY                     9.80665
+#define DEG_TO_RAD                  (3.14159265358979 / 180.0)
+
+static mpu6050_integ_handle_t test_integ_init(void)
+{
+	mpu6050_integ_handle_t handle = mpu6050_integ_init();
+	mpu6050_integ_cfg_t cfg = {
+		.interval_us = INTERVAL_US,
+		.gravity = 0,
+		.buf_size = 16,
+	};
+	mpu6050_integ_set_config(handle, cfg);
+
+	return handle;
+}
+
+static void test_fill(mpu6050_scale_sample_t *samples, uint64_t *timestamp_us, const float accel[3], const float gyro[3], uint64_t t0)
+{
+	for (int n = 0; n < NUM_SAMPLE; n++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			samples[n].accel[i] = accel[i];
+			samples[n].gyro[i] = gyro[i];
+		}
+		timestamp_us[n] = t0 + (uint64_t)n * SAMPLE_PERIOD_US;
+	}
+}
+
+static int test_constant_rate(void)
+{
+	static const float accel[3] = {0, 0, 0};
+	static const float gyro[3] = {10.0f, -20.0f, 30.0f};
+	mpu6050_scale_sample_t samples[NUM_SAMPLE];
+	uint64_t timestamp_us[NUM_SAMPLE];
+	test_fill(samples, timestamp_us, accel, gyro, 0);
+
+	mpu6050_integ_handle_t handle = test_integ_init();
+	CHECK(mpu6050_integ_update(handle, samples, timestamp_us, NUM_SAMPLE) == ERR_CODE_SUCCESS);
+
+	mpu6050_integ_delta_t deltas[16];
+	uint16_t num_delta;
+	CHECK(mpu6050_integ_read(handle, deltas, 16, &num_delta) == ERR_CODE_SUCCESS);
+	CHECK(num_delta == NUM_DELTA);
+
+	/* Fixed axis rotation has no coning, delta angle = w * T */
+	for (int k = 0; k < num_delta; k++)
+	{
+		CHECK(deltas[k].t_start_us == (uint64_t)k * INTERVAL_US);
+		CHECK(deltas[k].t_end_us == (uint64_t)(k + 1) * INTERVAL_US);
+		CHECK(deltas[k].num_sample == INTERVAL_US / SAMPLE_PERIOD_US);
+		for (int i = 0; i < 3; i++)
+		{
+			CHECK_NEAR(deltas[k].delta_angle[i], gyro[i] * DEG_TO_RAD * INTERVAL_US * 1e-6, 1e-6);
+			CHECK_NEAR(deltas[k].delta_velocity[i], 0, 1e-9);
+		}
+	}
+
+	mpu6050_integ_deinit(handle);
+	return 0;
+}
+
+static int test_constant_force(void)
+{
+	static const float accel[3] = {0.1f, -0.2f, 1.0f};
+	static const float gyro[3] = {0, 0, 0};
+	mpu6050_scale_sample_t samples[NUM_SAMPLE];
+	uint64_t timestamp_us[NUM_SAMPLE];
+	test_fill(samples, timestamp_us, accel, gyro, 0);
+
+	mpu6050_integ_handle_t handle = test_integ_init();
+	CHECK(mpu6050_integ_update(handle, samples, timestamp_us, NUM_SAMPLE) == ERR_CODE_SUCCESS);
+
+	mpu6050_integ_delta_t deltas[16];
+	uint16_t num_delta;
+	CHECK(mpu6050_integ_read(handle, deltas, 16, &num_delta) == ERR_CODE_SUCCESS);
+	CHECK(num_delta == NUM_DELTA);
+
+	/* No rotation, delta velocity = f * T */
+	for (int k = 0; k < num_delta; k++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			CHECK_NEAR(deltas[k].delta_velocity[i], accel[i] * GRAVITY * INTERVAL_US * 1e-6, 1e-6);
+			CHECK_NEAR(deltas[k].delta_angle[i], 0, 1e-9);
+		}
+	}
+
+	mpu6050_integ_deinit(handle);
+	return 0;
+}
+
+static int test_rotation_term(void)
+{
+	/* Constant rate about z while a constant force acts along body x */
+	static const float accel[3] = {1.0f, 0, 0};
+	static const float gyro[3] = {0, 0, 90.0f};
+	mpu6050_scale_sample_t samples[NUM_SAMPLE];
+	uint64_t timestamp_us[NUM_SAMPLE];
+	test_fill(samples, timestamp_us, accel, gyro, 0);
+
+	mpu6050_integ_handle_t handle = test_integ_init();
+	CHECK(mpu6050_integ_update(handle, samples, timestamp_us, NUM_SAMPLE) == ERR_CODE_SUCCESS);
+
+	mpu6050_integ_delta_t deltas[16];
+	uint16_t num_delta;
+	CHECK(mpu6050_integ_read(handle, deltas, 16, &num_delta) == ERR_CODE_SUCCESS);
+	CHECK(num_delta == NUM_DELTA);
+
+	/* In the interval start frame the force turns with the body:
+	 * delta v = f / w * (sin(w * T), 1 - cos(w * T), 0), where the y part
+	 * comes from the 1/2 alpha x nu rotation term.
+	 */
+	double w = gyro[2] * DEG_TO_RAD;
+	double f = accel[0] * GRAVITY;
+	double T = INTERVAL_US * 1e-6;
+	for (int k = 0; k < num_delta; k++)
+	{
+		CHECK_NEAR(deltas[k].delta_velocity[0], f / w * sin(w * T), 1e-5);
+		CHECK_NEAR(deltas[k].delta_velocity[1], f / w * (1.0 - cos(w * T)), 1e-5);
+		CHECK_NEAR(deltas[k].delta_velocity[2], 0, 1e-9);
+		CHECK_NEAR(deltas[k].delta_velocity[1], 0.5 * (w * T) * (f * T), 1e-5);
+	}
+
+	mpu6050_integ_deinit(handle);
+	return 0;
+}
+
+static int test_timestamp_restart(void)
+{
+	static const float accel[3] = {0, 0, 1.0f};
+	static const float gyro[3] = {0, 0, 10.0f};
+	mpu6050_scale_sample_t samples[NUM_SAMPLE];
+	uint64_t timestamp_us[NUM_SAMPLE];
+	test_fill(samples, timestamp_us, accel, gyro, 0);
+
+	/* Time source restarts at sample 25, in the middle of the third interval */
+	for (int n = 25; n < NUM_SAMPLE; n++)
+	{
+		timestamp_us[n] = (uint64_t)(n - 25) * SAMPLE_PERIOD_US;
+	}
+
+	mpu6050_integ_handle_t handle = test_integ_init();
+	CHECK(mpu6050_integ_update(handle, samples, timestamp_us, NUM_SAMPLE) == ERR_CODE_SUCCESS);
+
+	mpu6050_integ_delta_t deltas[16];
+	uint16_t num_delta;
+	CHECK(mpu6050_integ_read(handle, deltas, 16, &num_delta) == ERR_CODE_SUCCESS);
+
+	/* Two intervals before the restart, seven full intervals after it */
+	CHECK(num_delta == 2 + 7);
+	CHECK(deltas[1].t_end_us == 2 * INTERVAL_US);
+	for (int k = 2; k < num_delta; k++)
+	{
+		CHECK(deltas[k].t_start_us == (uint64_t)(k - 2) * INTERVAL_US);
+		CHECK(deltas[k].num_sample == INTERVAL_US / SAMPLE_PERIOD_US);
+		CHECK_NEAR(deltas[k].delta_angle[2], gyro[2] * DEG_TO_RAD * INTERVAL_US * 1e-6, 1e-6);
+	}
+
+	mpu6050_integ_deinit(handle);
+	return 0;
+}
+
+int main(void)
+{
+	int ret = 0;
+
+	ret |= test_constant_rate();
+	ret |= test_constant_force();
+	ret |= test_rotation_term();
+	ret |= test_timestamp_restart();
+
+	printf("test_mpu6050_integ: %s\n", (ret == 0) ? "PASS" : "FAIL");
+
+	return ret;
+}
@@ -0,0 +1,79 @@
+#include "stdio.h"
+#include "string.h"
+#include "mpu6050.h"
+#include "mpu6050_multirate.h"
+
+#define CHECK(cond)                                                             \
+	do {                                                                        \
+		if (!(cond))                                                            \
+		{                                                                       \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+			return 1;                                                           \
+		}                                                                       \
+	} while (0)
+
+#define NUM_INPUT                   1000
+#define BATCH_SIZE                  7           /*!< Not a multiple of any decim under test */
+
+static const mpu6050_raw_sample_t dc_sample = {
+	.accel = {1000, -32768, 16384},
+	.gyro = {32767, -5, 0},
+};
+
+static int test_dc_gain(uint16_t decim, uint8_t order)
+{
+	mpu6050_multirate_handle_t handle = mpu6050_multirate_init();
+	CHECK(handle != NULL);
+
+	uint8_t output_id;
+	mpu6050_multirate_output_cfg_t cfg = {
+		.decim = decim,
+		.order = order,
+		.buf_size = NUM_INPUT,
+	};
+	CHECK(mpu6050_multirate_add_output(handle, cfg, &output_id) == ERR_CODE_SUCCESS);
+
+	static mpu6050_raw_sample_t in[NUM_INPUT];
+	for (int i = 0; i < NUM_INPUT; i++)
+	{
+		in[i] = dc_sample;
+	}
+
+	/* One output per decim inputs, whatever the batch boundaries */
+	static mpu6050_raw_sample_t out[NUM_INPUT];
+	uint32_t num_out = 0;
+	for (uint32_t i = 0; i < NUM_INPUT; i += BATCH_SIZE)
+	{
+		uint32_t num = (NUM_INPUT - i < BATCH_SIZE) ? (NUM_INPUT - i) : BATCH_SIZE;
+		CHECK(mpu6050_multirate_update(handle, &in[i], num) == ERR_CODE_SUCCESS);
+
+		uint16_t num_read;
+		CHECK(mpu6050_multirate_read(handle, output_id, &out[num_out], NUM_INPUT - num_out, &num_read) == ERR_CODE_SUCCESS);
+		num_out += num_read;
+		CHECK(num_out == (i + num) / decim);
+	}
+	CHECK(num_out == NUM_INPUT / decim);
+
+	/* Unity DC gain, exact once the comb delay lines are filled */
+	for (uint32_t k = order; k < num_out; k++)
+	{
+		CHECK(memcmp(&out[k], &dc_sample, sizeof(dc_sample)) == 0);
+	}
+
+	mpu6050_multirate_deinit(handle);
+	return 0;
+}
+
+int main(void)
+{
+	int ret = 0;
+
+	ret |= test_dc_gain(1, 1);
+	ret |= test_dc_gain(10, 3);
+	ret |= test_dc_gain(100, 3);
+	ret |= test_dc_gain(64, MPU6050_MULTIRATE_ORDER_MAX);
+
+	printf("test_mpu6050_multirate: %s\n", (ret == 0) ? "PASS" : "FAIL");
+
+	return ret;
+}